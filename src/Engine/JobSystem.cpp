@@ -1,6 +1,7 @@
 #include "JobSystem.hpp"
 #include <cstddef>
 #include "Jobs.hpp"
+#include "trace.h"
 
 
 void worker(SharedData& data, const JobQueue& jobs) {
@@ -12,3 +13,82 @@ void worker(SharedData& data, const JobQueue& jobs) {
         jobs[jobIndex]();
     }
 }
+
+
+JobSystem::JobSystem(unsigned count) {
+    if (count == 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        count = hw > 1 ? hw - 1 : 0;
+    }
+
+    threads.reserve(count);
+    for (unsigned i = 0; i < count; i++) {
+        threads.emplace_back(&JobSystem::loop, this);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lk(data.m);
+        data.running.store(false);
+    }
+    data.cv.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+void JobSystem::run(const JobQueue& jobs) {
+    if (jobs.size() == 0) return;
+
+    std::lock_guard<std::mutex> batch(runMx);
+
+    // a single job isn't worth waking anyone for.
+    if (threads.empty() || jobs.size() == 1) {
+        for (size_t i = 0; i < jobs.size(); i++) jobs[i]();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(data.m);
+        current = &jobs;
+        data.totalJobs = jobs.size();
+        data.nextJobIndex.store(0);
+        data.active = threads.size();
+        data.generation++;
+    }
+    data.cv.notify_all();
+
+    {
+        TRACE_SCOPE("jobs");
+        worker(data, jobs);
+    }
+
+    // every pool thread has to leave worker() before the queue can be reused or freed.
+    TRACE_SCOPE("wait for workers");
+    std::unique_lock<std::mutex> lk(data.m);
+    data.idle.wait(lk, [this] { return data.active == 0; });
+    current = nullptr;
+}
+
+void JobSystem::loop() {
+    size_t seen = 0;
+    TRACE_THREAD("job worker");
+
+    while (true) {
+        const JobQueue* jobs;
+        {
+            std::unique_lock<std::mutex> lk(data.m);
+            data.cv.wait(lk, [&] { return !data.running.load() || data.generation != seen; });
+            if (!data.running.load()) return;
+            seen = data.generation;
+            jobs = current;
+        }
+
+        {
+            TRACE_SCOPE("jobs");
+            worker(data, *jobs);
+        }
+
+        std::lock_guard<std::mutex> lk(data.m);
+        if (--data.active == 0) data.idle.notify_one();
+    }
+}
@@ -3,6 +3,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <cstddef>
+#include <thread>
+#include <vector>
 
 
 
@@ -19,7 +21,41 @@ struct SharedData {
 
     std::atomic<std::size_t> nextJobIndex{0};
     std::size_t              totalJobs{0};
+
+
+    // batch bookkeeping for JobSystem: bumped once per run(), and the number of
+    // pool threads still inside that batch (signalled on `idle` when it hits 0).
+    std::size_t             generation{0};
+    std::size_t             active{0};
+    std::condition_variable idle;
 };
 
 
 void worker(SharedData& data, const JobQueue& jobs);
+
+
+// Persistent worker threads that drain a JobQueue together with the calling thread.
+// run() blocks until every job has finished, so jobs may capture locals by reference.
+// One batch at a time: concurrent run() calls from different threads are serialized.
+class JobSystem {
+public:
+    // threads = extra worker threads; 0 picks hardware_concurrency() - 1.
+    explicit JobSystem(unsigned threads = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void run(const JobQueue& jobs);
+
+    // worker threads plus the caller.
+    unsigned concurrency() const { return (unsigned)threads.size() + 1; }
+
+private:
+    void loop();
+
+    SharedData data;
+    const JobQueue* current = nullptr;
+    std::mutex runMx;
+    std::vector<std::thread> threads;
+};
@@ -1,4 +1,5 @@
 #include "Networking.hpp"
+#include "trace.h"
 #include <cassert>
 #include <cstring>
 #include <thread>
@@ -36,7 +37,7 @@ Server::Server(const ServerConfig& cfg)
 
 
     {
-        std::lock_guard<std::mutex> lk(worldMx);
+        auto lk = Trace::lock(worldMx, "worldMx");
         for (auto s : cfg.platforms) {
             Platform p;
             p.id = s.id;
@@ -49,7 +50,7 @@ Server::Server(const ServerConfig& cfg)
     for (auto [id, port] : cfg.clients) {
         clientThreads.push_back(ClientThread{id, port, std::thread()});
 
-        std::lock_guard<std::mutex> lk(worldMx);
+        auto lk = Trace::lock(worldMx, "worldMx");
         players.emplace(id, Player{});
     }
 }
@@ -79,6 +80,7 @@ void Server::stop() {
 }
 
 void Server::worldLoop() {
+    TRACE_THREAD("server world");
     using namespace std::chrono;
     const auto dt = duration<double>(1.0 / worldHz);
     auto next = Clock::now();
@@ -87,7 +89,8 @@ void Server::worldLoop() {
         std::chrono::duration<double>(1.0 / worldHz)
 );
         {
-            std::lock_guard<std::mutex> lk(worldMx);
+            TRACE_SCOPE("world step");
+            auto lk = Trace::lock(worldMx, "worldMx");
             stepPlatforms(dt.count());
             stepPlayers(dt.count());
             tick++;
@@ -158,6 +161,7 @@ void Server::snapshotFor(uint32_t client_id, StateMsg& out){
 }
 
 void Server::clientRepLoop(uint32_t client_id, int port){
+    TRACE_THREAD("server client rep");
     void* rep = make_socket(zmq_ctx, ZMQ_REP);
     if (!bind_tcp(rep, port)) {
 
@@ -168,18 +172,23 @@ void Server::clientRepLoop(uint32_t client_id, int port){
 
 
     {
-        std::lock_guard<std::mutex> lk(worldMx);
+        auto lk = Trace::lock(worldMx, "worldMx");
         players.emplace(client_id, Player{});
     }
 
     while (running.load()) {
         InputMsg in{};
-        int n = recv_buf(rep, &in, sizeof(in));
+        int n;
+        {
+            TRACE_SCOPE("recv input");
+            n = recv_buf(rep, &in, sizeof(in));
+        }
         if (n <= 0) continue;
+        TRACE_SCOPE("client rep");
 
         if (in.kind == MsgKind::Input && in.proto_ver == PROTO_VER && in.client_id == client_id) {
 
-            std::lock_guard<std::mutex> lk(worldMx);
+            auto lk = Trace::lock(worldMx, "worldMx");
             auto it = players.find(client_id);
             if (it != players.end()) {
                 it->second.left  = (in.left  != 0);
@@ -191,7 +200,7 @@ void Server::clientRepLoop(uint32_t client_id, int port){
 
         StateMsg out{};
         {
-            std::lock_guard<std::mutex> lk(worldMx);
+            auto lk = Trace::lock(worldMx, "worldMx");
             snapshotFor(client_id, out);
         }
         send_buf(rep, &out, sizeof(out));
@@ -0,0 +1,296 @@
+#include "aabb_tree.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+
+    /*
+     * how far ahead of a moving box its fat box reaches, in multiples of the last move.
+     */
+    static const float PREDICTION = 4.0f;
+
+    AABBTree::AABBTree(float margin) : margin(margin) {}
+
+    AABBTree::Box AABBTree::merge(const Box& a, const Box& b) {
+        return {std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+    }
+
+    bool AABBTree::encloses(const Box& outer, const Box& inner) {
+        return outer.x0 <= inner.x0 && outer.y0 <= inner.y0 && inner.x1 <= outer.x1 && inner.y1 <= outer.y1;
+    }
+
+    void AABBTree::clear() {
+        nodes.clear();
+        items.clear();
+        root = freeList = NONE;
+        count = 0;
+    }
+
+    int32_t AABBTree::allocate() {
+        if (freeList == NONE) {
+            nodes.emplace_back();
+            return (int32_t)nodes.size() - 1;
+        }
+        int32_t node = freeList;
+        freeList = nodes[node].parent;
+        nodes[node] = Node{};
+        return node;
+    }
+
+    void AABBTree::release(int32_t node) {
+        nodes[node].parent = freeList;
+        nodes[node].height = -1;
+        freeList = node;
+    }
+
+    void AABBTree::insert(uint32_t id, const SDL_FRect& rect) {
+        if (id >= items.size()) items.resize(id + 1);
+
+        Item& item = items[id];
+        Box box = toBox(rect);
+        Box fat = {box.x0 - margin, box.y0 - margin, box.x1 + margin, box.y1 + margin};
+
+        if (item.leaf != NONE) {
+            // reach ahead in the direction it's moving, so a steady mover stays inside for a few frames.
+            float dx = PREDICTION * (box.x0 - item.box.x0), dy = PREDICTION * (box.y0 - item.box.y0);
+            if (dx < 0) fat.x0 += dx; else fat.x1 += dx;
+            if (dy < 0) fat.y0 += dy; else fat.y1 += dy;
+            item.box = box;
+
+            // still inside, and the fat box isn't left far too big by a mover that has since stopped.
+            const Box& current = nodes[item.leaf].box;
+            float slack = 4.0f * margin;
+            Box limit = {fat.x0 - slack, fat.y0 - slack, fat.x1 + slack, fat.y1 + slack};
+            if (encloses(current, box) && encloses(limit, current)) return;
+
+            removeLeaf(item.leaf);
+            nodes[item.leaf].box = fat;
+            insertLeaf(item.leaf);
+            return;
+        }
+
+        int32_t leaf = allocate();
+        nodes[leaf].box = fat;
+        nodes[leaf].id = id;
+        items[id].leaf = leaf;
+        items[id].box = box;
+        count++;
+        insertLeaf(leaf);
+    }
+
+    void AABBTree::remove(uint32_t id) {
+        if (!contains(id)) return;
+
+        int32_t leaf = items[id].leaf;
+        removeLeaf(leaf);
+        release(leaf);
+        items[id].leaf = NONE;
+        count--;
+    }
+
+    void AABBTree::insertLeaf(int32_t leaf) {
+        if (root == NONE) {
+            root = leaf;
+            nodes[leaf].parent = NONE;
+            return;
+        }
+
+        // go down towards the sibling that makes the tree's total perimeter grow least.
+        Box box = nodes[leaf].box;
+        int32_t index = root;
+        while (!nodes[index].isLeaf()) {
+            const Node& node = nodes[index];
+            float area = perimeter(node.box);
+            float combined = perimeter(merge(node.box, box));
+
+            // pairing with this node makes one new parent; going further down also grows this node.
+            float cost = 2.0f * combined;
+            float inherited = 2.0f * (combined - area);
+
+            auto descend = [&](int32_t child) {
+                const Node& c = nodes[child];
+                float grown = perimeter(merge(box, c.box));
+                return (c.isLeaf() ? grown : grown - perimeter(c.box)) + inherited;
+            };
+            float cost1 = descend(node.child1);
+            float cost2 = descend(node.child2);
+
+            if (cost < cost1 && cost < cost2) break;
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        int32_t sibling = index;
+        int32_t oldParent = nodes[sibling].parent;
+        int32_t parent = allocate();
+        nodes[parent].parent = oldParent;
+        nodes[parent].box = merge(box, nodes[sibling].box);
+        nodes[parent].height = nodes[sibling].height + 1;
+        nodes[parent].child1 = sibling;
+        nodes[parent].child2 = leaf;
+        nodes[sibling].parent = parent;
+        nodes[leaf].parent = parent;
+
+        if (oldParent == NONE) root = parent;
+        else if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = parent;
+        else nodes[oldParent].child2 = parent;
+
+        refit(parent);
+    }
+
+    void AABBTree::removeLeaf(int32_t leaf) {
+        if (leaf == root) {
+            root = NONE;
+            return;
+        }
+
+        // the leaf's parent goes too; its other child takes the parent's place.
+        int32_t parent = nodes[leaf].parent;
+        int32_t grandParent = nodes[parent].parent;
+        int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        nodes[sibling].parent = grandParent;
+        release(parent);
+        if (grandParent == NONE) {
+            root = sibling;
+            return;
+        }
+        if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+        else nodes[grandParent].child2 = sibling;
+        refit(grandParent);
+    }
+
+    void AABBTree::refit(int32_t index) {
+        while (index != NONE) {
+            index = balance(index);
+            Node& node = nodes[index];
+            node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+            node.box = merge(nodes[node.child1].box, nodes[node.child2].box);
+            index = node.parent;
+        }
+    }
+
+    int32_t AABBTree::balance(int32_t iA) {
+        Node& A = nodes[iA];
+        if (A.isLeaf() || A.height < 2) return iA;
+
+        int32_t iB = A.child1, iC = A.child2;
+        Node& B = nodes[iB];
+        Node& C = nodes[iC];
+        int32_t diff = C.height - B.height;
+        if (diff >= -1 && diff <= 1) return iA;
+
+        // rotate the taller child (P) up into A's place; A takes P's shorter child, P keeps the taller one.
+        int32_t iP = diff > 1 ? iC : iB;
+        Node& P = nodes[iP];
+        Node& other = diff > 1 ? B : C;
+        int32_t iF = P.child1, iG = P.child2;
+        Node& F = nodes[iF];
+        Node& G = nodes[iG];
+
+        P.child1 = iA;
+        P.parent = A.parent;
+        A.parent = iP;
+        if (P.parent == NONE) root = iP;
+        else if (nodes[P.parent].child1 == iA) nodes[P.parent].child1 = iP;
+        else nodes[P.parent].child2 = iP;
+
+        int32_t iKeep = F.height > G.height ? iF : iG;
+        int32_t iGive = F.height > G.height ? iG : iF;
+        P.child2 = iKeep;
+        if (diff > 1) A.child2 = iGive;
+        else A.child1 = iGive;
+        nodes[iGive].parent = iA;
+
+        A.box = merge(other.box, nodes[iGive].box);
+        A.height = 1 + std::max(other.height, nodes[iGive].height);
+        P.box = merge(A.box, nodes[iKeep].box);
+        P.height = 1 + std::max(A.height, nodes[iKeep].height);
+        return iP;
+    }
+
+    void AABBTree::rebuild() {
+        std::vector<int32_t> leaves;
+        leaves.reserve(count);
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (nodes[i].height == 0) leaves.push_back((int32_t)i);
+            else if (nodes[i].height > 0) release((int32_t)i);
+        }
+
+        root = leaves.empty() ? NONE : build(leaves.data(), leaves.size());
+        if (root != NONE) nodes[root].parent = NONE;
+    }
+
+    int32_t AABBTree::build(int32_t* leaves, size_t n) {
+        if (n == 1) return leaves[0];
+
+        // split at the median along the longer side of the box around the centers.
+        // centers are kept doubled (x0 + x1); only their order matters.
+        Box centers = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+        for (size_t i = 0; i < n; i++) {
+            const Box& b = nodes[leaves[i]].box;
+            float cx = b.x0 + b.x1, cy = b.y0 + b.y1;
+            centers = merge(centers, {cx, cy, cx, cy});
+        }
+        bool alongX = centers.x1 - centers.x0 >= centers.y1 - centers.y0;
+        size_t half = n / 2;
+        std::nth_element(leaves, leaves + half, leaves + n, [&](int32_t a, int32_t b) {
+            const Box& ba = nodes[a].box;
+            const Box& bb = nodes[b].box;
+            return alongX ? ba.x0 + ba.x1 < bb.x0 + bb.x1 : ba.y0 + ba.y1 < bb.y0 + bb.y1;
+        });
+
+        int32_t child1 = build(leaves, half);
+        int32_t child2 = build(leaves + half, n - half);
+        int32_t node = allocate();
+        Node& parent = nodes[node];
+        parent.child1 = child1;
+        parent.child2 = child2;
+        parent.box = merge(nodes[child1].box, nodes[child2].box);
+        parent.height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[child1].parent = node;
+        nodes[child2].parent = node;
+        return node;
+    }
+
+    template <class F>
+    void AABBTree::visit(const Box& area, F&& f) const {
+        if (root == NONE) return;
+
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const Node& node = nodes[stack.back()];
+            stack.pop_back();
+            if (!overlaps(node.box, area)) continue;
+
+            if (node.isLeaf()) {
+                if (overlaps(items[node.id].box, area)) f(node.id);
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    void AABBTree::query(const SDL_FRect& area, std::vector<uint32_t>& out) const {
+        visit(toBox(area), [&](uint32_t id) {out.push_back(id);});
+    }
+
+    void AABBTree::pairs(std::vector<std::pair<uint32_t, uint32_t>>& out) const {
+        for (uint32_t id = 0; id < items.size(); id++) {
+            if (items[id].leaf == NONE) continue;
+            visit(items[id].box, [&](uint32_t other) {
+                if (other > id) out.emplace_back(id, other);
+            });
+        }
+    }
+
+    void AABBTree::pairs(const AABBTree& other, std::vector<std::pair<uint32_t, uint32_t>>& out) const {
+        for (uint32_t id = 0; id < items.size(); id++) {
+            if (items[id].leaf == NONE) continue;
+            other.visit(items[id].box, [&](uint32_t o) {
+                out.emplace_back(std::min(id, o), std::max(id, o));
+            });
+        }
+    }
+}
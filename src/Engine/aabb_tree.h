@@ -0,0 +1,124 @@
+#pragma once
+#include <SDL3/SDL_rect.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Engine {
+
+    /*
+     * bounding volume hierarchy of axis-aligned boxes, keyed by small integer ids: the same queries as
+     * SpatialHash, answered by descending a balanced binary tree, so a region or point query costs
+     * O(log n) plus the hits whatever the spread or size of the boxes.
+     *
+     * works like Box2D's dynamic tree. each leaf holds a "fat" box: the real box grown by `margin` and stretched
+     * along the direction it last moved. moving a box that stays inside its fat box only stores it; one that
+     * leaves is taken out and inserted again next to the sibling that grows the tree's perimeter least, and the
+     * path back to the root is rebalanced with rotations. a margin of 0 suits boxes that rarely move.
+     * rebuild() throws the inner nodes away and builds the tree again top-down, which gives a better tree than
+     * one built up by insertions (e.g. after loading a level).
+     *
+     * ids index a flat array, so keep them dense (e.g. World handle slots).
+     * not thread-safe.
+     */
+    class AABBTree {
+        public:
+            explicit AABBTree(float margin = 4.0f);
+
+            /*
+             * insert a box, or move it if the id is already present.
+             */
+            void insert(uint32_t id, const SDL_FRect& box);
+
+            /*
+             * remove a box. removing an id that isn't present does nothing.
+             */
+            void remove(uint32_t id);
+
+            bool contains(uint32_t id) const {return id < items.size() && items[id].leaf != NONE;}
+            size_t size() const {return count;}
+            void clear();
+
+            /*
+             * build the tree again from its boxes, top-down.
+             */
+            void rebuild();
+
+            /*
+             * append to `out` the id of every box that overlaps `area` (touching edges don't count), each once.
+             * ids come out in no particular order.
+             */
+            void query(const SDL_FRect& area, std::vector<uint32_t>& out) const;
+
+            /*
+             * append to `out` every pair of boxes that overlap each other, each once, as (lower id, higher id).
+             */
+            void pairs(std::vector<std::pair<uint32_t, uint32_t>>& out) const;
+
+            /*
+             * append to `out` every pair of a box in this tree and a box in `other` that overlap, as (lower id, higher id).
+             * the two trees must not share ids.
+             */
+            void pairs(const AABBTree& other, std::vector<std::pair<uint32_t, uint32_t>>& out) const;
+
+            /*
+             * levels from the root to the deepest leaf (0 when empty), for checking the balance.
+             */
+            int getHeight() const {return root == NONE ? 0 : nodes[root].height + 1;}
+
+        private:
+            static const int32_t NONE = -1;
+
+            struct Box {
+                float x0, y0, x1, y1;
+            };
+
+            struct Node {
+                Box box;                // fat box for leaves, union of the children for inner nodes
+                int32_t parent = NONE;  // next free node while unused
+                int32_t child1 = NONE;
+                int32_t child2 = NONE;
+                int32_t height = 0;     // 0 for leaves, -1 for unused nodes
+                uint32_t id = 0;
+
+                bool isLeaf() const {return child1 == NONE;}
+            };
+
+            struct Item {
+                Box box;
+                int32_t leaf = NONE;
+            };
+
+            static Box toBox(const SDL_FRect& r) {return {r.x, r.y, r.x + r.w, r.y + r.h};}
+            static Box merge(const Box& a, const Box& b);
+            static float perimeter(const Box& b) {return 2.0f * ((b.x1 - b.x0) + (b.y1 - b.y0));}
+            static bool encloses(const Box& outer, const Box& inner);
+            static bool overlaps(const Box& a, const Box& b) {
+                return a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+            }
+
+            int32_t allocate();
+            void release(int32_t node);
+            void insertLeaf(int32_t leaf);
+            void removeLeaf(int32_t leaf);
+            void refit(int32_t node);
+            int32_t balance(int32_t a);
+            int32_t build(int32_t* leaves, size_t count);
+
+            /*
+             * call f(id) for every box overlapping `area`.
+             */
+            template <class F>
+            void visit(const Box& area, F&& f) const;
+
+            float margin;
+            std::vector<Node> nodes;
+            int32_t root = NONE;
+            int32_t freeList = NONE;
+            std::vector<Item> items;
+            size_t count = 0;
+
+            mutable std::vector<int32_t> stack;
+    };
+}
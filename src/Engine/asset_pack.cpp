@@ -0,0 +1,256 @@
+#include "asset_pack.h"
+#include <SDL3/SDL_log.h>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Engine {
+
+    static const char MAGIC[4] = {'G', 'P', 'A', 'K'};
+    static const size_t PIXEL_ALIGN = 16;
+
+    static size_t alignUp(size_t v, size_t a) {return (v + a - 1) & ~(a - 1);}
+
+    uint64_t AssetPack::hash(const char* path, size_t length, int w, int h) {
+        // FNV-1a over the path, then the size.
+        uint64_t x = 1469598103934665603ull;
+        for (size_t i = 0; i < length; i++) {
+            x ^= (uint8_t)path[i];
+            x *= 1099511628211ull;
+        }
+        x ^= ((uint64_t)(uint32_t)w << 32) | (uint32_t)h;
+        x *= 1099511628211ull;
+        x ^= x >> 29;
+        return x ? x : 1;
+    }
+
+    AssetPack::~AssetPack() {
+        close();
+    }
+
+    bool AssetPack::open(const std::string& file) {
+        close();
+
+#ifdef _WIN32
+        HANDLE f = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (f == INVALID_HANDLE_VALUE) {
+            SDL_Log("Can't open asset pack %s", file.c_str());
+            return false;
+        }
+        LARGE_INTEGER length;
+        GetFileSizeEx(f, &length);
+        HANDLE m = length.QuadPart > 0 ? CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        CloseHandle(f);
+        const void* view = m ? MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            if (m) CloseHandle(m);
+            SDL_Log("Can't map asset pack %s", file.c_str());
+            return false;
+        }
+        mapping = m;
+        size = (size_t)length.QuadPart;
+#else
+        int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd < 0) {
+            SDL_Log("Can't open asset pack %s", file.c_str());
+            return false;
+        }
+        struct stat st;
+        void* view = (fstat(fd, &st) == 0 && st.st_size > 0) ? mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            SDL_Log("Can't map asset pack %s", file.c_str());
+            return false;
+        }
+        size = (size_t)st.st_size;
+#endif
+        data = (const uint8_t*)view;
+
+        if (!validate(file)) {
+            close();
+            return false;
+        }
+        header = (const Header*)data;
+        slots = (const Slot*)(data + sizeof(Header));
+        return true;
+    }
+
+    bool AssetPack::validate(const std::string& file) const {
+        auto fail = [&](const char* why) {
+            SDL_Log("Asset pack %s is invalid: %s", file.c_str(), why);
+            return false;
+        };
+
+        if (size < sizeof(Header)) return fail("too small");
+        const Header* h = (const Header*)data;
+        if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0) return fail("not an asset pack");
+        if (h->version != VERSION) return fail("unsupported version");
+        if (h->fileSize != size) return fail("truncated");
+        if (h->slotCount == 0 || (h->slotCount & (h->slotCount - 1)) != 0 || h->count >= h->slotCount) return fail("bad index");
+        if (sizeof(Header) + (uint64_t)h->slotCount * sizeof(Slot) > size) return fail("bad index");
+
+        // check every slot once here, so lookups can trust the offsets.
+        const Slot* s = (const Slot*)(data + sizeof(Header));
+        uint32_t used = 0;
+        for (uint32_t i = 0; i < h->slotCount; i++) {
+            if (s[i].hash == 0) continue;
+            used++;
+            uint64_t pixels = (uint64_t)s[i].w * s[i].h * 4;
+            if ((uint64_t)s[i].pathOffset + s[i].pathLength > size) return fail("bad path");
+            if (s[i].w == 0 || s[i].h == 0 || s[i].w > 1u << 15 || s[i].h > 1u << 15) return fail("bad image size");
+            if (s[i].offset % PIXEL_ALIGN != 0 || s[i].offset > size || pixels > size - s[i].offset) return fail("bad image");
+        }
+        if (used != h->count) return fail("bad index");
+        return true;
+    }
+
+    void AssetPack::close() {
+        if (!data) return;
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle((HANDLE)mapping);
+#else
+        munmap((void*)data, size);
+#endif
+        data = nullptr;
+        size = 0;
+        header = nullptr;
+        slots = nullptr;
+        mapping = nullptr;
+    }
+
+    const AssetPack::Slot* AssetPack::lookup(const std::string& path, int w, int h) const {
+        if (!data) return nullptr;
+
+        bool original = w <= 0 && h <= 0;
+        uint64_t key = hash(path.data(), path.size(), original ? 0 : w, original ? 0 : h);
+        uint32_t mask = header->slotCount - 1;
+        for (uint32_t i = (uint32_t)key & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.hash == 0) return nullptr;
+            if (slot.hash != key || slot.pathLength != path.size() || (slot.original != 0) != original) continue;
+            if (!original && (slot.w != (uint32_t)w || slot.h != (uint32_t)h)) continue;
+            if (std::memcmp(data + slot.pathOffset, path.data(), path.size()) == 0) return &slot;
+        }
+    }
+
+    PackedImage AssetPack::find(const std::string& path, int w, int h) const {
+        const Slot* slot = lookup(path, w, h);
+        // asking for an image at its own size finds the original.
+        if (!slot && w > 0 && h > 0) {
+            slot = lookup(path, 0, 0);
+            if (slot && (slot->w != (uint32_t)w || slot->h != (uint32_t)h)) slot = nullptr;
+        }
+        if (!slot) return {};
+        return {data + slot->offset, (int)slot->w, (int)slot->h, (int)slot->w * 4};
+    }
+
+    bool AssetPack::getImageSize(const std::string& path, int& w, int& h) const {
+        const Slot* slot = lookup(path, 0, 0);
+        if (!slot) return false;
+        w = (int)slot->w;
+        h = (int)slot->h;
+        return true;
+    }
+
+    void AssetPackWriter::add(const std::string& path, int w, int h, const void* pixels, int pitch, bool original) {
+        if (w <= 0 || h <= 0 || !pixels) return;
+        for (const Image& image : images) {
+            if (image.path == path && image.original == original && (original || (image.w == w && image.h == h))) return;
+        }
+
+        Image image{path, w, h, original, std::vector<uint8_t>((size_t)w * h * 4)};
+        for (int y = 0; y < h; y++) {
+            std::memcpy(&image.pixels[(size_t)y * w * 4], (const uint8_t*)pixels + (size_t)y * pitch, (size_t)w * 4);
+        }
+        images.push_back(std::move(image));
+    }
+
+    bool AssetPackWriter::write(const std::string& file) const {
+        // keep the table at most half full, so probes stay short.
+        uint32_t slotCount = 1;
+        while (slotCount < images.size() * 2 + 1) slotCount *= 2;
+
+        std::vector<AssetPack::Slot> slots(slotCount);
+        std::memset(slots.data(), 0, slots.size() * sizeof(AssetPack::Slot));
+
+        size_t pathStart = sizeof(AssetPack::Header) + slots.size() * sizeof(AssetPack::Slot);
+        size_t offset = pathStart;
+        std::vector<size_t> pathOffsets;
+        for (const Image& image : images) {
+            pathOffsets.push_back(offset);
+            offset += image.path.size();
+        }
+
+        if (offset > UINT32_MAX) {
+            SDL_Log("Asset pack %s has too many paths", file.c_str());
+            return false;
+        }
+        size_t pathEnd = offset;
+
+        std::vector<size_t> pixelOffsets;
+        for (const Image& image : images) {
+            offset = alignUp(offset, PIXEL_ALIGN);
+            pixelOffsets.push_back(offset);
+            offset += image.pixels.size();
+        }
+
+        for (size_t i = 0; i < images.size(); i++) {
+            const Image& image = images[i];
+            AssetPack::Slot slot{};
+            slot.hash = AssetPack::hash(image.path.data(), image.path.size(), image.original ? 0 : image.w, image.original ? 0 : image.h);
+            slot.offset = pixelOffsets[i];
+            slot.pathOffset = (uint32_t)pathOffsets[i];
+            slot.pathLength = (uint32_t)image.path.size();
+            slot.w = (uint32_t)image.w;
+            slot.h = (uint32_t)image.h;
+            slot.original = image.original ? 1 : 0;
+
+            uint32_t mask = slotCount - 1;
+            uint32_t j = (uint32_t)slot.hash & mask;
+            while (slots[j].hash != 0) j = (j + 1) & mask;
+            slots[j] = slot;
+        }
+
+        AssetPack::Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = AssetPack::VERSION;
+        header.count = (uint32_t)images.size();
+        header.slotCount = slotCount;
+        header.fileSize = offset;
+
+        FILE* f = std::fopen(file.c_str(), "wb");
+        if (!f) {
+            SDL_Log("Can't write asset pack %s", file.c_str());
+            return false;
+        }
+
+        bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+                  std::fwrite(slots.data(), sizeof(AssetPack::Slot), slots.size(), f) == slots.size();
+        for (const Image& image : images) {
+            ok = ok && std::fwrite(image.path.data(), 1, image.path.size(), f) == image.path.size();
+        }
+        size_t written = pathEnd;
+        static const uint8_t zeros[PIXEL_ALIGN] = {};
+        for (size_t i = 0; i < images.size() && ok; i++) {
+            size_t gap = pixelOffsets[i] - written;
+            ok = (gap == 0 || std::fwrite(zeros, 1, gap, f) == gap) &&
+                 std::fwrite(images[i].pixels.data(), 1, images[i].pixels.size(), f) == images[i].pixels.size();
+            written = pixelOffsets[i] + images[i].pixels.size();
+        }
+
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok) SDL_Log("Can't write asset pack %s", file.c_str());
+        return ok;
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+    /*
+     * an image stored in an asset pack: w x h pixels, 4 bytes each in R, G, B, A order, rows `pitch` bytes apart.
+     * points straight into the mapped file, so it is only valid while the pack stays open.
+     */
+    struct PackedImage {
+        const void* pixels = nullptr;
+        int w = 0, h = 0;
+        int pitch = 0;
+
+        explicit operator bool() const {return pixels != nullptr;}
+    };
+
+    /*
+     * read-only view of an asset pack: one file holding already-decoded images, built offline by AssetPacker
+     * (src/asset_packer.cpp) from the PNGs in media/.
+     *
+     * the file is memory-mapped rather than read, so opening it costs nothing up front and pages are brought in
+     * as images are used. images are found through an open-addressed hash table stored in the file, keyed by the path
+     * they were packed under (e.g. "media/hand.png") and a size: each image is stored at its own size, and optionally
+     * again at sizes scaled ahead of time so they can be uploaded as they are.
+     *
+     * layout (native byte order): Header, then Header::slotCount Slots, then the paths, then the pixels,
+     * each image starting on a 16 byte boundary.
+     */
+    class AssetPack {
+        public:
+            static const uint32_t VERSION = 1;
+
+            struct Header {
+                char magic[4];          // "GPAK"
+                uint32_t version;
+                uint32_t count;         // images stored
+                uint32_t slotCount;     // hash table size, a power of two
+                uint64_t fileSize;
+            };
+
+            struct Slot {
+                uint64_t hash;          // 0 marks an empty slot
+                uint64_t offset;        // of the first pixel, from the start of the file
+                uint32_t pathOffset;
+                uint32_t pathLength;
+                uint32_t w, h;
+                uint32_t original;      // 1 if this is the image at its own size
+                uint32_t reserved;
+            };
+
+            /*
+             * hash of a (path, size) key. the image at its own size is keyed with size 0 x 0.
+             */
+            static uint64_t hash(const char* path, size_t length, int w, int h);
+
+            AssetPack() = default;
+            ~AssetPack();
+
+            AssetPack(const AssetPack&) = delete;
+            AssetPack& operator=(const AssetPack&) = delete;
+
+            /*
+             * map the pack at `file`, closing any pack already open. returns false (and logs why) if the file
+             * is missing or isn't a valid pack.
+             */
+            bool open(const std::string& file);
+            void close();
+            bool isOpen() const {return data != nullptr;}
+
+            /*
+             * the image packed under `path` at exactly w x h, or at its own size if both are 0.
+             * returns an empty image if the pack doesn't have it.
+             */
+            PackedImage find(const std::string& path, int w = 0, int h = 0) const;
+
+            /*
+             * whether the pack has `path` at all, and its own size if so.
+             */
+            bool contains(const std::string& path) const {return (bool)find(path);}
+            bool getImageSize(const std::string& path, int& w, int& h) const;
+
+            size_t getCount() const {return header ? header->count : 0;}
+
+        private:
+            const Slot* lookup(const std::string& path, int w, int h) const;
+            bool validate(const std::string& file) const;
+
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+            const Header* header = nullptr;
+            const Slot* slots = nullptr;
+            void* mapping = nullptr;
+    };
+
+    /*
+     * builds an asset pack. used by the AssetPacker tool; the engine itself only reads packs.
+     */
+    class AssetPackWriter {
+        public:
+            /*
+             * copy w x h RGBA pixels (rows `pitch` bytes apart) into the pack under `path`, either as the image
+             * at its own size or as a pre-scaled copy. adding the same (path, size) twice keeps the first.
+             */
+            void add(const std::string& path, int w, int h, const void* pixels, int pitch, bool original);
+
+            /*
+             * write the pack to `file`. returns false (and logs why) if it can't be written.
+             */
+            bool write(const std::string& file) const;
+
+            size_t getCount() const {return images.size();}
+
+        private:
+            struct Image {
+                std::string path;
+                int w, h;
+                bool original;
+                std::vector<uint8_t> pixels;
+            };
+
+            std::vector<Image> images;
+    };
+}
@@ -0,0 +1,104 @@
+#include "atlas.h"
+#include "core.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+
+namespace Engine {
+
+    AtlasPacker::AtlasPacker(int pageSize, int padding) : pageSize(pageSize), padding(std::max(0, padding)) {}
+
+    AtlasPacker::~AtlasPacker() {
+        clear();
+    }
+
+    void AtlasPacker::clear() {
+        for (Page& page : pages) SDL_DestroyTexture(page.texture);
+        pages.clear();
+    }
+
+    void AtlasPacker::removePage(SDL_Texture* texture) {
+        auto it = std::find_if(pages.begin(), pages.end(), [texture](const Page& p) {return p.texture == texture;});
+        if (it == pages.end()) return;
+        SDL_DestroyTexture(it->texture);
+        pages.erase(it);
+    }
+
+    bool AtlasPacker::place(Page& page, int w, int h, int& x, int& y) {
+        // best fit: the lowest shelf that is tall enough and still has room.
+        Shelf* best = nullptr;
+        for (Shelf& shelf : page.shelves) {
+            if (shelf.height >= h && shelf.x + w <= pageSize && (!best || shelf.height < best->height)) best = &shelf;
+        }
+
+        // don't bury a short sprite in a much taller shelf if a new shelf still fits.
+        if (best && best->height > h * 2 && page.top + h <= pageSize) best = nullptr;
+
+        if (!best) {
+            if (page.top + h > pageSize) return false;
+            page.shelves.push_back({page.top, h, 0});
+            page.top += h;
+            best = &page.shelves.back();
+        }
+
+        x = best->x;
+        y = best->y;
+        best->x += w;
+        return true;
+    }
+
+    AtlasPacker::Page* AtlasPacker::newPage() {
+        SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, pageSize, pageSize);
+        if (!texture) {
+            SDL_Log("Can't create atlas page: %s", SDL_GetError());
+            return nullptr;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+        // render targets start with undefined contents; the padding has to be transparent.
+        SDL_Texture* target = SDL_GetRenderTarget(renderer);
+        Uint8 r, g, b, a;
+        SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+        SDL_SetRenderTarget(renderer, texture);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        SDL_SetRenderDrawColor(renderer, r, g, b, a);
+        SDL_SetRenderTarget(renderer, target);
+
+        pages.push_back({texture, {}, 0});
+        return &pages.back();
+    }
+
+    TextureRegion AtlasPacker::add(SDL_Texture* source, int w, int h) {
+        if (!source || !renderer || w <= 0 || h <= 0) return {};
+
+        int paddedW = w + 2 * padding, paddedH = h + 2 * padding;
+        if (paddedW > pageSize || paddedH > pageSize) return {};
+
+        Page* page = nullptr;
+        int x = 0, y = 0;
+        for (Page& p : pages) {
+            if (place(p, paddedW, paddedH, x, y)) {
+                page = &p;
+                break;
+            }
+        }
+        if (!page) {
+            page = newPage();
+            if (!page || !place(*page, paddedW, paddedH, x, y)) return {};
+        }
+
+        SDL_FRect dst{(float)(x + padding), (float)(y + padding), (float)w, (float)h};
+
+        // copy the pixels as they are, alpha included, rather than blending them onto the page.
+        SDL_BlendMode blend;
+        SDL_GetTextureBlendMode(source, &blend);
+        SDL_SetTextureBlendMode(source, SDL_BLENDMODE_NONE);
+        SDL_Texture* target = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, page->texture);
+        SDL_RenderTexture(renderer, source, nullptr, &dst);
+        SDL_SetRenderTarget(renderer, target);
+        SDL_SetTextureBlendMode(source, blend);
+
+        return {page->texture, dst};
+    }
+}
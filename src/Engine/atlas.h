@@ -0,0 +1,77 @@
+#pragma once
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+#include <cstddef>
+#include <vector>
+
+namespace Engine {
+
+    /*
+     * a rectangle of a texture to draw from: a whole texture, or one sprite on a shared atlas page.
+     */
+    struct TextureRegion {
+        SDL_Texture* texture = nullptr;
+        SDL_FRect src = {0, 0, 0, 0};
+
+        explicit operator bool() const {return texture != nullptr;}
+    };
+
+    /*
+     * packs small sprites into a few large render-target pages, so sprites that share a page
+     * can be drawn in a single SpriteBatch run.
+     *
+     * pages are filled shelf by shelf (rows as tall as their tallest sprite), with transparent
+     * padding around each sprite so filtering doesn't bleed neighbours into each other.
+     * space is only reclaimed a whole page at a time. uses the render API, so call it on the main thread.
+     */
+    class AtlasPacker {
+        public:
+            AtlasPacker(int pageSize = 2048, int padding = 2);
+            ~AtlasPacker();
+
+            AtlasPacker(const AtlasPacker&) = delete;
+            AtlasPacker& operator=(const AtlasPacker&) = delete;
+
+            /*
+             * copy `source`, scaled to w x h, into a page (opening a new page if none has room).
+             * returns an empty region if the sprite is larger than a page or the page can't be created.
+             */
+            TextureRegion add(SDL_Texture* source, int w, int h);
+
+            /*
+             * the pages created so far.
+             */
+            size_t getPageCount() const {return pages.size();}
+            SDL_Texture* getPage(size_t i) const {return pages[i].texture;}
+            int getPageSize() const {return pageSize;}
+
+            /*
+             * destroy one page (everything packed into it becomes invalid), or all of them.
+             */
+            void removePage(SDL_Texture* page);
+            void clear();
+
+            /*
+             * forget every page without destroying it, for when the renderer that owned them is already gone.
+             */
+            void abandon() {pages.clear();}
+
+        private:
+            struct Shelf {
+                int y, height, x;
+            };
+
+            struct Page {
+                SDL_Texture* texture;
+                std::vector<Shelf> shelves;
+                int top = 0;
+            };
+
+            bool place(Page& page, int w, int h, int& x, int& y);
+            Page* newPage();
+
+            int pageSize;
+            int padding;
+            std::vector<Page> pages;
+    };
+}
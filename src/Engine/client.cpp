@@ -1,4 +1,5 @@
 #include "Engine/client.h"
+#include "Engine/trace.h"
 
 #include <zmq.h>
 #include <cstring>
@@ -279,19 +280,19 @@ void Client::p2pPublishEvent(uint32_t eventKind, float x, float y, const char* e
 }
 
 std::vector<Client::NetworkEventData> Client::getPendingNetworkEvents() {
-    std::lock_guard<std::mutex> lk(networkEventsMtx_);
+    auto lk = Trace::lock(networkEventsMtx_, "wait networkEventsMtx_");
     std::vector<NetworkEventData> result;
     result.swap(pendingNetworkEvents_);
     return result;
 }
 
 std::unordered_map<int, XY> Client::snapshot() const {
-    std::scoped_lock lk(snap_mx_);
+    auto lk = Trace::lock(snap_mx_, "wait snap_mx_");
     return snap_;
 }
 
 std::vector<XY> Client::platforms() const {
-    std::scoped_lock lk(plat_mx_);
+    auto lk = Trace::lock(plat_mx_, "wait plat_mx_");
     return platforms_;
 }
 
@@ -535,6 +536,7 @@ void Client::authorityMaybeStepAndBroadcast_() {
 
 
 void Client::p2pRxLoop_() {
+    TRACE_THREAD("p2p rx");
     set_rcvtimeo(subPeers_, 0);
     uint8_t buf[4096];
 
@@ -546,8 +548,10 @@ void Client::p2pRxLoop_() {
     static auto nextPrune = std::chrono::steady_clock::now();
 
     while (p2pRunning_.load()) {
+        TRACE_SCOPE("p2p iteration");
 
         int n = 0;
+        const auto drainStart = Trace::Clock::now();
         do {
             n = zmq_recv(subPeers_, buf, sizeof(buf), ZMQ_DONTWAIT);
             if (n > 0 && static_cast<size_t>(n) >= sizeof(P2PHeader)) {
@@ -556,7 +560,7 @@ void Client::p2pRxLoop_() {
                 if (h->kind == P2PKind::Player && static_cast<size_t>(n) >= sizeof(P2PPlayer)) {
                     const auto* ps = reinterpret_cast<const P2PPlayer*>(buf);
                     if (ps->player_id != my_id_.load()) {
-                        std::lock_guard<std::mutex> lk(peersMtx_);
+                        auto lk = Trace::lock(peersMtx_, "wait peersMtx_");
                         auto& rp = peers_[ps->player_id];
                         rp.id       = ps->player_id;
                         rp.x        = ps->x;
@@ -583,7 +587,7 @@ void Client::p2pRxLoop_() {
                         for (uint32_t i=0; i<w->platform_count; ++i) {
                             plats.push_back(XY{arr[i].x, arr[i].y});
                         }
-                        { std::scoped_lock l2(plat_mx_); platforms_.swap(plats); }
+                        { auto l2 = Trace::lock(plat_mx_, "wait plat_mx_"); platforms_.swap(plats); }
                         lastP2PWorldRecvNs_.store(nowNs(), std::memory_order_relaxed);
                     }
                 } else if (h->kind == P2PKind::Event && static_cast<size_t>(n) >= sizeof(P2PEvent)) {
@@ -591,7 +595,7 @@ void Client::p2pRxLoop_() {
                     if (evt->player_id != my_id_.load()) {
                         // Store event for processing in main loop
                         {
-                            std::lock_guard<std::mutex> lk(networkEventsMtx_);
+                            auto lk = Trace::lock(networkEventsMtx_, "wait networkEventsMtx_");
                             NetworkEventData netEvt;
                             netEvt.eventKind = evt->event_kind;
                             netEvt.x = evt->x;
@@ -606,11 +610,16 @@ void Client::p2pRxLoop_() {
                 }
             }
         } while (n > 0);
+        Trace::complete("p2p drain", drainStart, Trace::Clock::now());
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        {
+            TRACE_SCOPE("p2p sleep");
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
 
         auto now = std::chrono::steady_clock::now();
         if (now >= nextDirRefresh_) {
+            TRACE_SCOPE("p2p directory refresh");
             p2pQueryDirectoryAndConnect_();
             nextDirRefresh_ = now + std::chrono::milliseconds(500);
         }
@@ -620,7 +629,7 @@ void Client::p2pRxLoop_() {
             const int64_t staleNs = 3'000'000'000LL;
             const int64_t cutoff = nowNs() - staleNs;
 
-            std::lock_guard<std::mutex> lk(peersMtx_);
+            auto lk = Trace::lock(peersMtx_, "wait peersMtx_");
             for (auto it = peers_.begin(); it != peers_.end(); ) {
                 if (it->second.lastRecvNs.load() < cutoff) it = peers_.erase(it);
                 else ++it;
@@ -631,7 +640,7 @@ void Client::p2pRxLoop_() {
 
         int minId = my_id_.load();
         {
-            std::lock_guard<std::mutex> lk(peersMtx_);
+            auto lk = Trace::lock(peersMtx_, "wait peersMtx_");
             for (const auto& kv : peers_) { if (kv.first < minId) minId = kv.first; }
         }
 
@@ -649,7 +658,7 @@ void Client::p2pRxLoop_() {
 }
 
 std::unordered_map<int, RemotePeerData> Client::p2pSnapshot() {
-    std::lock_guard<std::mutex> lk(peersMtx_);
+    auto lk = Trace::lock(peersMtx_, "wait peersMtx_");
 
     std::unordered_map<int, RemotePeerData> out;
     out.reserve(peers_.size());
@@ -1,8 +1,8 @@
 #include "collision.h"
-#include "core.h"
-#include "vec2.h"
 #include <SDL3/SDL_rect.h>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace Engine::Collision {
     bool check(Entity* a, Entity* b) {
@@ -12,72 +12,155 @@ namespace Engine::Collision {
     };
 
     std::vector<Entity*> all(Entity* e) {
+        return all(*e->getWorld(), e);
+    };
+
+    std::vector<Entity*> all(World& world, Entity* e) {
         std::vector<Entity*> out;
-        for (auto cmp : entities) {
-            if (cmp == e || !cmp->hasCollisions()) continue;
-            if (check(cmp, e)) out.push_back(cmp);
-        }
+        all(world, e, out);
         return out;
     };
 
-    int _checkEdge_internal(SDL_FRect a_box, SDL_FRect b_box, Vec2 &a_pos, Vec2 &b_pos) {
-        SDL_FRect overlap;
-        if (!SDL_GetRectIntersectionFloat(&a_box, &b_box, &overlap)) return NO_COLLISION;
+    void all(Entity* e, std::vector<Entity*>& out) {
+        all(*e->getWorld(), e, out);
+    };
 
-        if (overlap.w >= overlap.h) {
+    void all(World& world, Entity* e, std::vector<Entity*>& out) {
+        size_t first = out.size();
+        world.queryCollidable(e->getBoundingBox(), out);
 
+        // the broadphase may return near misses; check() has the final say.
+        size_t kept = first;
+        for (size_t i = first; i < out.size(); i++) {
+            if (out[i] != e && check(out[i], e)) out[kept++] = out[i];
+        }
+        out.resize(kept);
+    };
+
+    void pairs(World& world, std::vector<std::pair<Entity*, Entity*>>& out) {
+        size_t first = out.size();
+        world.queryCollidablePairs(out);
 
-            if (a_pos.y < b_pos.y) {
-                return BOTTOM;
-            } else {
-                return TOP;
-            }
-        } else {
+        size_t kept = first;
+        for (size_t i = first; i < out.size(); i++) {
+            if (check(out[i].first, out[i].second)) out[kept++] = out[i];
+        }
+        out.resize(kept);
+    };
 
+    void at(World& world, float x, float y, std::vector<Entity*>& out) {
+        size_t first = out.size();
+        world.queryCollidable({x, y, 0, 0}, out);
 
-            if (a_pos.x < b_pos.x) {
-                return RIGHT;
-            } else {
-                return LEFT;
-            }
+        size_t kept = first;
+        for (size_t i = first; i < out.size(); i++) {
+            SDL_FRect box = out[i]->getBoundingBox();
+            if (x >= box.x && x <= box.x + box.w && y >= box.y && y <= box.y + box.h) out[kept++] = out[i];
         }
-    }
+        out.resize(kept);
+    };
 
-    int checkEdge(Entity* a, Entity* b) {
-     
+    const char* name(World::Broadphase broadphase) {
+        switch (broadphase) {
+            case World::SWEEP_AND_PRUNE: return "sweep";
+            case World::AABB_TREE: return "tree";
+            default: return "grid";
+        }
+    };
 
-        const float STEP_SIZE = 1;
+    World::Broadphase fromName(const char* name) {
+        for (World::Broadphase b : {World::SWEEP_AND_PRUNE, World::AABB_TREE}) {
+            if (std::strcmp(name, Collision::name(b)) == 0) return b;
+        }
+        return World::GRID;
+    };
 
-        SDL_FRect a_box = a->getBoundingBox();
-        SDL_FRect b_box = b->getBoundingBox();
+    /*
+     * edge code and normal for boxes that already overlap: the axis they overlap least on (TOP or BOTTOM on a tie),
+     * and the side of b that a ends up on, with a's top-left corner ending at (endX, endY).
+     */
+    static Hit overlapHit(const SDL_FRect& a, const SDL_FRect& b, float endX, float endY) {
+        float w = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+        float h = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+        if (w >= h) return endY < b.y ? Hit{BOTTOM, 0.0f, 0.0f, -1.0f} : Hit{TOP, 0.0f, 0.0f, 1.0f};
+        return endX < b.x ? Hit{RIGHT, 0.0f, -1.0f, 0.0f} : Hit{LEFT, 0.0f, 1.0f, 0.0f};
+    }
 
-        if (!check(a, b)) return NO_COLLISION;
+    /*
+     * when, as fractions of a move of d, the span [a0, a1] starts and stops overlapping [b0, b1] (touching counts).
+     * false if it never does.
+     */
+    static bool slab(float a0, float a1, float d, float b0, float b1, float& enter, float& exit) {
+        if (d == 0) {
+            enter = -INFINITY;
+            exit = INFINITY;
+            return a0 <= b1 && b0 <= a1;
+        }
+        float inv = 1.0f / d;
+        float near = (d > 0 ? b0 - a1 : b1 - a0) * inv;
+        float far = (d > 0 ? b1 - a0 : b0 - a1) * inv;
+        enter = near;
+        exit = far;
+        return true;
+    }
 
-        Vec2 a_pos = a->getPos();
-        Vec2 b_pos = b->getPos();
+    Hit sweep(const SDL_FRect& a, float dx, float dy, const SDL_FRect& b) {
+        float enterX, exitX, enterY, exitY;
+        if (!slab(a.x, a.x + a.w, dx, b.x, b.x + b.w, enterX, exitX)) return Hit{};
+        if (!slab(a.y, a.y + a.h, dy, b.y, b.y + b.h, enterY, exitY)) return Hit{};
 
-        Vec2 d_v, step;
-        Vec2_sub(a->getVelocity(), b->getVelocity(), d_v);
-        Vec2_scale(d_v, timeline->getDelta());
-        Vec2_normalize(d_v, step);
-        Vec2_scale(step, STEP_SIZE);
+        float enter = std::max(enterX, enterY);
+        float exit = std::min(exitX, exitY);
+        if (!(enter <= exit) || enter > 1.0f || exit < 0.0f) return Hit{};
 
-        int n = Vec2_length(d_v) / STEP_SIZE;
-        int code = 0;
+        if (enter <= 0.0f) return overlapHit(a, b, a.x + dx, a.y + dy);
 
+        // the axis that closed last is the one they met on.
+        if (enterX > enterY) {
+            return dx > 0 ? Hit{RIGHT, enter, -1.0f, 0.0f} : Hit{LEFT, enter, 1.0f, 0.0f};
+        }
+        return dy > 0 ? Hit{BOTTOM, enter, 0.0f, -1.0f} : Hit{TOP, enter, 0.0f, 1.0f};
+    }
 
-        a_box.x -= d_v.x;
-        a_box.y -= d_v.y;
+    Hit sweep(Entity* a, Entity* b, float dt) {
+        float dx = (a->getVelocityX() - b->getVelocityX()) * dt;
+        float dy = (a->getVelocityY() - b->getVelocityY()) * dt;
+        SDL_FRect start = a->getBoundingBox();
+        start.x -= dx;
+        start.y -= dy;
+        return sweep(start, dx, dy, b->getBoundingBox());
+    }
 
-        for (int i = 0; i <= n; i++) {
-            code = _checkEdge_internal(a_box, b_box, a_pos, b_pos);
-            if (code != NO_COLLISION) return code;
+    void sweep(const std::vector<std::pair<Entity*, Entity*>>& pairs, float dt, std::vector<Hit>& out) {
+        out.resize(pairs.size());
+        for (size_t i = 0; i < pairs.size(); i++) {
+            out[i] = sweep(pairs[i].first, pairs[i].second, dt);
+        }
+    }
 
-            a_box.x += step.x;
-            a_box.y += step.y;
+    void sweep(const SDL_FRect* a, const float* dx, const float* dy, const SDL_FRect* b, size_t count, Hit* out) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = sweep(a[i], dx[i], dy[i], b[i]);
         }
+    }
+
+    int checkEdge(Entity* a, Entity* b) {
+        return checkEdge(*a->getWorld(), a, b);
+    };
 
+    int checkEdge(World& world, Entity* a, Entity* b) {
+        return checkEdge(a, b, world.getTimeline().getDelta());
+    };
+
+    int checkEdge(Entity* a, Entity* b, float dt) {
+        if (!check(a, b)) return NO_COLLISION;
 
-        return NO_COLLISION;
+        Hit hit = sweep(a, b, dt);
+        // they overlap now, so only rounding in the sweep can miss; fall back to the overlap itself.
+        if (hit.edge == NO_COLLISION) {
+            SDL_FRect box = a->getBoundingBox();
+            return overlapHit(box, b->getBoundingBox(), box.x, box.y).edge;
+        }
+        return hit.edge;
     };
 }
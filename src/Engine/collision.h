@@ -1,8 +1,18 @@
 #pragma once
 
 #include "entity.h"
+#include "world.h"
+#include <SDL3/SDL_rect.h>
+#include <cstddef>
+#include <utility>
 #include <vector>
 
+/*
+ * collision queries against a world's COLLIDE phase entities.
+ * the queries (all, pairs, at) bring the world's collision index up to date as they go, so they must run on
+ * the thread stepping the world and never from a parallel entity update (see Entity::setParallelUpdate);
+ * debug builds assert this. defer() them from there instead.
+ */
 namespace Engine::Collision {
 
  
@@ -12,6 +22,37 @@ namespace Engine::Collision {
   
     std::vector<Entity*> all(Entity* e);
 
+    /*
+     * every collidable entity in the given world that overlaps e.
+     * all(e) is the same as all(*e->getWorld(), e).
+     */
+    std::vector<Entity*> all(World& world, Entity* e);
+
+    /*
+     * all(), appending to `out` instead of allocating, so one buffer can be reused for every query of a frame.
+     * candidates come from the world's collision index (see World::queryCollidable), in COLLIDE phase order.
+     */
+    void all(Entity* e, std::vector<Entity*>& out);
+    void all(World& world, Entity* e, std::vector<Entity*>& out);
+
+    /*
+     * append to `out` every pair of collidable entities in world that overlap, each pair once.
+     * much cheaper than calling all() for every entity when most of them are being checked anyway.
+     */
+    void pairs(World& world, std::vector<std::pair<Entity*, Entity*>>& out);
+
+    /*
+     * append to `out` every collidable entity in world whose bounding box contains the point (x, y), edges included.
+     */
+    void at(World& world, float x, float y, std::vector<Entity*>& out);
+
+    /*
+     * lowercase name of a broadphase ("grid", "sweep", "tree"), and the reverse.
+     * fromName returns GRID for unknown names.
+     */
+    const char* name(World::Broadphase broadphase);
+    World::Broadphase fromName(const char* name);
+
 
  
     const int NO_COLLISION = 0;
@@ -22,4 +63,47 @@ namespace Engine::Collision {
 
 
     int checkEdge(Entity* a, Entity* b);
+
+    /*
+     * which edge of a hits b, sweeping back over the last frame of relative movement measured on world's timeline.
+     * checkEdge(a, b) is the same as checkEdge(*a->getWorld(), a, b).
+     */
+    int checkEdge(World& world, Entity* a, Entity* b);
+
+    /*
+     * checkEdge over the last `dt` seconds of relative movement, without reading any timeline.
+     * NO_COLLISION unless a and b overlap now.
+     */
+    int checkEdge(Entity* a, Entity* b, float dt);
+
+    /*
+     * first contact of a moving box with a still one.
+     * edge is the edge of a that hit (LEFT, RIGHT, TOP, BOTTOM) or NO_COLLISION, time the fraction of the move
+     * at which they first touch, and (normalX, normalY) the normal of b's side that was hit, pointing back at a.
+     * boxes that already overlap at the start hit at time 0, on the side they overlap least.
+     */
+    struct Hit {
+        int edge = NO_COLLISION;
+        float time = 1.0f;
+        float normalX = 0.0f, normalY = 0.0f;
+    };
+
+    /*
+     * analytic swept-AABB test: box a moving by (dx, dy) against box b, touching counts (like check()).
+     * costs the same however far a moves.
+     */
+    Hit sweep(const SDL_FRect& a, float dx, float dy, const SDL_FRect& b);
+
+    /*
+     * sweep a back over the last `dt` seconds of its velocity relative to b, ending where both are now.
+     * unlike check(), this also finds bodies that passed through each other during the step.
+     */
+    Hit sweep(Entity* a, Entity* b, float dt);
+
+    /*
+     * many sweeps at once: out[i] is the sweep of pairs[i] (e.g. from pairs()) over dt, or of a[i] moving by
+     * (dx[i], dy[i]) against b[i].
+     */
+    void sweep(const std::vector<std::pair<Entity*, Entity*>>& pairs, float dt, std::vector<Hit>& out);
+    void sweep(const SDL_FRect* a, const float* dx, const float* dy, const SDL_FRect* b, size_t count, Hit* out);
 }
@@ -2,25 +2,65 @@
 #include "entity.h"
 #include "physics.h"
 #include "input.h"
+#include "particles.h"
+#include "world.h"
+#include "JobSystem.hpp"
+#include "profiler.h"
+#include "scaling.h"
+#include "sprite_batch.h"
+#include "static_layers.h"
+#include "texture_cache.h"
+#include "trace.h"
 #include <SDL3/SDL.h>
 #include <vector>
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <cmath>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace Engine {
     SDL_Window* window;
     SDL_Renderer* renderer;
 
-    std::vector<Entity*> entities;
     bool TERMINATE = false;
+    bool HEADLESS = false;
     int BACKGROUND_COLOR[3] = {0, 32, 128};
 
-    Timeline* timeline;
     static bool sShowRecordingIndicator = false;
     static bool sShowPlaybackIndicator = false;
     static OverlayRenderer sOverlayRenderer = nullptr;
 
+    /*
+     * a recorded frame: its draw commands (plus the static chunks to redraw and draw, and the particles),
+     * the camera position they were recorded at and how many drawable entities were culled.
+     */
+    struct Frame {
+        SpriteBatch batch;
+        StaticLayerCache::Commands statics;
+        ParticleBatch particles;
+        float cameraX = 0, cameraY = 0;
+        size_t culled = 0;
+    };
+
+    /*
+     * draw command buffers. without pipelining only the first is used; with it, the simulation
+     * fills one while the main thread renders the other (see setPipelinedRendering).
+     */
+    static Frame sFrames[2];
+    static Frame* sLastFrame = &sFrames[0];
+    static bool sPipelined = false;
+    static Camera* sCamera = nullptr;
+    static StaticLayerCache sStatic;
+    static ParticleSystem sParticles;
+    static SDL_Texture* sInternalTarget = nullptr;
+    static std::vector<Entity*> sVisible;
+    static std::unique_ptr<JobSystem> sJobs;
+
     void setBackgroundColor(int r, int g, int b) {
         BACKGROUND_COLOR[0] = r;
         BACKGROUND_COLOR[1] = g;
@@ -41,6 +81,149 @@ namespace Engine {
     void setOverlayRenderer(OverlayRenderer renderer) {
         sOverlayRenderer = renderer;
     }
+    void setFixedUpdate(FixedUpdate update) {
+        defaultWorld().setFixedUpdate(update);
+    }
+
+    void setFixedTimestep(float hz, int maxSteps) {defaultWorld().setFixedTimestep(hz, maxSteps);}
+    float getFixedTimestep() {return defaultWorld().getFixedTimestep();}
+    float getInterpolationAlpha() {return defaultWorld().getInterpolationAlpha();}
+    bool inFixedStep() {return defaultWorld().inFixedStep();}
+
+    std::vector<Entity*>& getEntities() {return defaultWorld().getEntities();}
+    Timeline& getTimeline() {return defaultWorld().getTimeline();}
+
+    SpriteBatch& getSpriteBatch() {return sLastFrame->batch;}
+    size_t getCulledCount() {return sLastFrame->culled;}
+    StaticLayerCache& getStaticLayers() {return sStatic;}
+    ParticleSystem& getParticles() {return sParticles;}
+    ParticleBatch& getParticleBatch() {return sLastFrame->particles;}
+
+    void setCamera(Camera* camera) {sCamera = camera;}
+    Camera* getCamera() {return sCamera;}
+
+    void setPipelinedRendering(bool pipelined) {sPipelined = pipelined;}
+    bool isPipelinedRendering() {return sPipelined;}
+
+    void setWorkerThreads(int threads) {
+        defaultWorld().setJobSystem(nullptr);
+        sJobs.reset();
+        if (threads <= 0) return;
+
+        sJobs = std::make_unique<JobSystem>((unsigned)threads);
+        defaultWorld().setJobSystem(sJobs.get());
+    }
+
+    /*
+     * queue the default world's DRAW phase entities that overlap `view` (the visible area,
+     * before the camera offset) into `frame`.
+     */
+    static void record(Frame& frame, SDL_FRect view) {
+        TRACE_SCOPE("record draws");
+        World& world = defaultWorld();
+
+        frame.cameraX = sCamera ? sCamera->x : 0.0f;
+        frame.cameraY = sCamera ? sCamera->y : 0.0f;
+        view.x += frame.cameraX;
+        view.y += frame.cameraY;
+
+        sVisible.clear();
+        world.queryDrawable(view, sVisible);
+
+        frame.batch.begin();
+        for (Entity* e : sVisible) {
+            e->draw(frame.batch);
+        }
+        sStatic.record(world, view, frame.statics);
+        sParticles.record(view, frame.particles);
+        frame.culled = world.getPhase(World::DRAW).size() - world.getStaticCount() - sVisible.size();
+
+        TRACE_COUNTER("sprites drawn", (double)sVisible.size());
+        TRACE_COUNTER("sprites culled", (double)frame.culled);
+    }
+
+    /*
+     * the WINDOW_WIDTH x WINDOW_HEIGHT target frames are drawn into in Scaling::INTERNAL_RESOLUTION mode,
+     * created on first use. null if it can't be created, in which case frames are drawn straight to the window.
+     */
+    static SDL_Texture* internalTarget() {
+        static bool failed = false;
+        if (sInternalTarget || failed) return sInternalTarget;
+
+        sInternalTarget = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, WINDOW_HEIGHT);
+        if (!sInternalTarget) {
+            SDL_Log("Can't create internal resolution target: %s", SDL_GetError());
+            failed = true;
+            return nullptr;
+        }
+        SDL_SetTextureBlendMode(sInternalTarget, SDL_BLENDMODE_NONE);
+        return sInternalTarget;
+    }
+
+    /*
+     * clear the screen, draw a recorded frame plus indicators and the overlay, then present.
+     */
+    static void render(Frame& frame) {
+        SDL_Texture* target = Scaling::getMode() == Scaling::INTERNAL_RESOLUTION ? internalTarget() : nullptr;
+
+        {
+            Profiler::Scope timer(Profiler::CLEAR);
+            if (target) SDL_SetRenderTarget(renderer, target);
+            SDL_SetRenderDrawColor(renderer,
+                BACKGROUND_COLOR[0],
+                BACKGROUND_COLOR[1],
+                BACKGROUND_COLOR[2],
+                255
+            );
+            SDL_RenderClear(renderer);
+        }
+
+
+        {
+            Profiler::Scope timer(Profiler::DRAW);
+            Scaling::Transform transform = Scaling::getTransform();
+            transform.tx -= frame.cameraX * transform.sx;
+            transform.ty -= frame.cameraY * transform.sy;
+            sStatic.render(renderer, frame.statics, frame.batch);
+            frame.batch.flush(renderer, transform);
+            frame.particles.flush(renderer, transform);
+            sLastFrame = &frame;
+
+            if (target) {
+                // the one scaling pass of the frame.
+                SDL_SetRenderTarget(renderer, nullptr);
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+                SDL_RenderClear(renderer);
+                SDL_FRect dst = Scaling::getPresentRect();
+                SDL_RenderTexture(renderer, target, nullptr, &dst);
+            }
+        }
+
+        if (sShowRecordingIndicator || sShowPlaybackIndicator) {
+            Profiler::Scope timer(Profiler::INDICATORS);
+            Uint8 r, g, b, a;
+            SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+
+            SDL_FRect dot{12.0f, 12.0f, 18.0f, 18.0f};
+            if (sShowRecordingIndicator) {
+                SDL_SetRenderDrawColor(renderer, 220, 20, 60, 255);
+                SDL_RenderFillRect(renderer, &dot);
+            } else if (sShowPlaybackIndicator) {
+                SDL_SetRenderDrawColor(renderer, 0, 200, 70, 255);
+                SDL_RenderFillRect(renderer, &dot);
+            }
+
+            SDL_SetRenderDrawColor(renderer, r, g, b, a);
+        }
+
+        if (sOverlayRenderer) {
+            Profiler::Scope timer(Profiler::OVERLAY);
+            sOverlayRenderer();
+        }
+
+        Profiler::Scope timer(Profiler::PRESENT);
+        SDL_RenderPresent(renderer);
+    }
 
     bool init(const char* windowTitle) {
 
@@ -51,106 +234,212 @@ namespace Engine {
 
         window = SDL_CreateWindow(windowTitle, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_RESIZABLE);
         renderer = SDL_CreateRenderer(window, nullptr);
-        timeline = new Timeline();
+        getTimeline().reset();
+        HEADLESS = false;
 
         if(!SDL_SetRenderVSync(renderer, 1))
             SDL_Log("Vsync not enabled.");
 
+        // on this thread, before anything can ask for it from another.
+        Textures::placeholder();
+
         return true;
     }
 
-    int main(void (*update)(float)) {
-        bool running = true;
-        TERMINATE = false;
-        SDL_Event e;
+    bool initHeadless() {
 
-        while (running) {
+        // events only, so SIGINT still arrives as SDL_EVENT_QUIT. no video subsystem, window or renderer.
+        if (!SDL_Init(SDL_INIT_EVENTS)) {
+            SDL_Log("SDL Init failed: %s", SDL_GetError());
+            return false;
+        }
 
-            while (SDL_PollEvent(&e)) {
-                if (e.type == SDL_EVENT_QUIT) running = false;
-            }
+        window = nullptr;
+        renderer = nullptr;
+        getTimeline().reset();
+        HEADLESS = true;
 
-            if (TERMINATE) {
-                TERMINATE = false;
-                running = false;
-            }
+        return true;
+    }
 
+    void step(float dt, void (*update)(float)) {
+        defaultWorld().advance(dt);
+        if (update) update(dt);
+    }
 
-            timeline->tick();
-            Input::update(timeline->getDelta());
+    /*
+     * runs one frame's simulation at a time on its own thread, handed over by the main loop.
+     */
+    class SimulationThread {
+        public:
+            SimulationThread() : thread(&SimulationThread::loop, this) {
+                // its phases count towards the main thread's frames (merged after each wait()).
+                Profiler::setHelperThread(thread.get_id());
+            }
+            ~SimulationThread() {
+                {
+                    std::lock_guard<std::mutex> lk(m);
+                    quit = true;
+                }
+                cv.notify_all();
+                thread.join();
+                Profiler::setHelperThread(std::thread::id());
+            }
 
+            void start(std::function<void()> frame) {
+                {
+                    std::lock_guard<std::mutex> lk(m);
+                    work = std::move(frame);
+                    busy = true;
+                }
+                cv.notify_all();
+            }
 
-            for (auto & e : entities) {
-                if (e->hasPhysics())
-                    Physics::apply(e, timeline->getDelta());
-                e->update(timeline->getDelta());
+            void wait() {
+                TRACE_SCOPE("wait for simulation");
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [this] { return !busy; });
             }
 
+        private:
+            void loop() {
+                TRACE_THREAD("simulation");
+                std::unique_lock<std::mutex> lk(m);
+                while (true) {
+                    cv.wait(lk, [this] { return quit || busy; });
+                    if (quit) return;
+
+                    lk.unlock();
+                    work();
+                    lk.lock();
+                    busy = false;
+                    cv.notify_all();
+                }
+            }
 
-            if (update) update(timeline->getDelta());
+            std::mutex m;
+            std::condition_variable cv;
+            std::function<void()> work;
+            bool busy = false;
+            bool quit = false;
+            std::thread thread;
+    };
 
+    int main(void (*update)(float)) {
+        bool running = true;
+        TERMINATE = false;
+        SDL_Event e;
+        TRACE_THREAD("main");
 
+        // frame N is simulated and recorded on this thread while the main thread presents frame N-1.
+        std::unique_ptr<SimulationThread> simulation;
+        if (sPipelined && !HEADLESS) simulation = std::make_unique<SimulationThread>();
+        int recording = 0;
+        sFrames[1].batch.begin();
 
-            SDL_SetRenderDrawColor(renderer,
-                BACKGROUND_COLOR[0],
-                BACKGROUND_COLOR[1],
-                BACKGROUND_COLOR[2],
-                255
-            );
-            SDL_RenderClear(renderer);
+        while (running) {
+            TRACE_SCOPE("frame");
+            Profiler::beginFrame();
 
+            {
+                Profiler::Scope timer(Profiler::EVENTS);
+                while (SDL_PollEvent(&e)) {
+                    if (e.type == SDL_EVENT_QUIT) running = false;
+                }
+            }
 
-            for (auto & e : entities) {
-                e->draw();
+            if (TERMINATE) {
+                TERMINATE = false;
+                running = false;
             }
 
-            if (sShowRecordingIndicator || sShowPlaybackIndicator) {
-                Uint8 r, g, b, a;
-                SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
-
-                SDL_FRect dot{12.0f, 12.0f, 18.0f, 18.0f};
-                if (sShowRecordingIndicator) {
-                    SDL_SetRenderDrawColor(renderer, 220, 20, 60, 255);
-                    SDL_RenderFillRect(renderer, &dot);
-                } else if (sShowPlaybackIndicator) {
-                    SDL_SetRenderDrawColor(renderer, 0, 200, 70, 255);
-                    SDL_RenderFillRect(renderer, &dot);
-                }
 
-                SDL_SetRenderDrawColor(renderer, r, g, b, a);
+            {
+                Profiler::Scope timer(Profiler::INPUT);
+                getTimeline().tick();
+                if (!HEADLESS)
+                    Input::update(getTimeline().getDelta());
             }
 
-            if (sOverlayRenderer) {
-                sOverlayRenderer();
+            if (!HEADLESS) {
+                Profiler::Scope timer(Profiler::UPLOAD);
+                Textures::pump(Textures::getUploadBudget());
             }
 
-            SDL_RenderPresent(renderer);
 
+            auto simulate = [update] {
+                World& world = defaultWorld();
+                Timeline& timeline = world.getTimeline();
+                world.advance(world.getFixedTimestep() > 0 ? timeline.getFrameTime() : timeline.getDelta());
+
+                {
+                    Profiler::Scope timer(Profiler::USER);
+                    if (update) update(timeline.getDelta());
+                }
+                {
+                    Profiler::Scope timer(Profiler::PARTICLES);
+                    sParticles.update(timeline.getDelta());
+                }
+                world.flushDestroyed();
+            };
+
+
+            if (HEADLESS) {
+                simulate();
+                // nothing to wait on without vsync; don't spin a core.
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            } else if (simulation) {
+                // the window belongs to the main thread, so measure the view here.
+                Frame& next = sFrames[recording];
+                SDL_FRect view = Scaling::getVisibleArea();
+                simulation->start([&simulate, &next, view] {
+                    simulate();
+                    record(next, view);
+                });
+                render(sFrames[recording ^ 1]);
+                simulation->wait();
+                Profiler::mergeHelper();
+                recording ^= 1;
+            } else {
+                simulate();
+                record(sFrames[0], Scaling::getVisibleArea());
+                render(sFrames[0]);
+            }
+
+            Profiler::endFrame();
         }
 
+        quit();
+        return 0;
+    }
 
+    void quit() {
+        defaultWorld().flushDestroyed();
+        std::vector<Entity*>& entities = getEntities();
         while (entities.size() > 0) {
             Entity* e = entities.back();
             delete e;
         }
-
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
+        setWorkerThreads(0);
+        sStatic.clear();
+        sParticles.clear();
+        Textures::clear();
+        if (sInternalTarget) SDL_DestroyTexture(sInternalTarget);
+        sInternalTarget = nullptr;
+
+        if (renderer) SDL_DestroyRenderer(renderer);
+        if (window) SDL_DestroyWindow(window);
+        renderer = nullptr;
+        window = nullptr;
         SDL_Quit();
-        return 0;
     }
 
     bool registerEntity(Engine::Entity *entity) {
-        for (auto & e : entities) {
-            if (e == entity) return false;
-        }
-        entities.push_back(entity);
-        return true;
+        return entity->getWorld()->add(entity);
     }
 
     bool unregisterEntity(Entity *entity) {
-        entities.erase(std::find(entities.begin(), entities.end(), entity));
-        return true;
+        return entity->getWorld()->remove(entity);
     }
 
     void stop() {TERMINATE = true;}
@@ -3,6 +3,11 @@
 #pragma once
 #include "entity.h"
 #include "timeline.h"
+#include "world.h"
+#include "camera.h"
+#include "sprite_batch.h"
+#include "static_layers.h"
+#include "particles.h"
 #include <SDL3/SDL.h>
 #include <vector>
 
@@ -34,9 +39,10 @@ namespace Engine {
     extern SDL_Renderer* renderer;
 
     /*
-     * lists all of the entities in the game/scene (no distinction at the moment)
+     * lists all of the entities in the game/scene. alias for defaultWorld().getEntities().
+     * a function rather than a global, so it also works from other translation units' static initializers.
      */
-    extern std::vector<Entity*> entities;
+    std::vector<Entity*>& getEntities();
 
     /*
      * terminate signal. used for ending the main() loop safely, without SDL_Quit occuring.
@@ -44,9 +50,14 @@ namespace Engine {
     extern bool TERMINATE;
 
     /*
-     * default timeline for the game and all game objects.
+     * true when the engine was started with initHeadless(): no video subsystem, window or renderer.
      */
-    extern Timeline* timeline;
+    extern bool HEADLESS;
+
+    /*
+     * default timeline for the game and all game objects. alias for defaultWorld().getTimeline().
+     */
+    Timeline& getTimeline();
 
     /*
      * sets the background color to the specified (r, g, b) value.
@@ -61,6 +72,22 @@ namespace Engine {
      */
     bool init(const char* windowTitle);
 
+    /*
+     * initializes the game engine without a window or renderer (no SDL video subsystem).
+     * for dedicated servers, benchmarks and CI: entities need explicit sizes (see Entity(float, float)),
+     * main() skips input and drawing, and the simulation can be driven manually with step().
+     *
+     * returns true on success, and false on failure.
+     */
+    bool initHeadless();
+
+    /*
+     * advance the simulation by dt seconds from code, without polling events, reading input or drawing.
+     * in fixed-timestep mode dt is fed into the step accumulator; otherwise exactly one step of dt is taken.
+     * the optional update function is called once afterwards with dt, like main() would.
+     */
+    void step(float dt, void (*update)(float) = nullptr);
+
     /*
      * run the main game loop.
      *
@@ -85,13 +112,19 @@ namespace Engine {
      void stop();
 
     /*
-     * add an entity to the global list of entities.
+     * destroy all entities and free the window, renderer and SDL.
+     * called automatically at the end of main(); call it yourself when driving the engine with step().
+     */
+    void quit();
+
+    /*
+     * add an entity to its world's list of entities.
      * meant for internal use
      */
     bool registerEntity(Entity* entity);
 
      /*
-      * remove an entity from the global list of entities.
+      * remove an entity from its world's list of entities.
       * meant for internal use. Called automatically when an entity is destroyed
       */
     bool unregisterEntity(Entity* entity);
@@ -108,4 +141,100 @@ namespace Engine {
     using OverlayRenderer = void (*)();
     void setOverlayRenderer(OverlayRenderer renderer);
 
+    /*
+     * the draw command buffer main() presented last. its counters (getSpriteCount, getDrawCalls)
+     * describe that frame, which makes them handy for an overlay.
+     */
+    SpriteBatch& getSpriteBatch();
+
+    /*
+     * number of drawable entities main() skipped in that frame because they were outside the view
+     * (Scaling::getVisibleArea(), moved by the camera if one is set). drawn ones are getSpriteBatch().getSpriteCount().
+     */
+    size_t getCulledCount();
+
+    /*
+     * the cache main() draws static entities through (see Entity::setStatic). its counters describe
+     * the last presented frame, whose sprite count has one quad per chunk layer in place of the static entities.
+     */
+    StaticLayerCache& getStaticLayers();
+
+    /*
+     * the particle system main() runs: updated with the frame delta right after the update function,
+     * and drawn above every sprite. getParticleBatch() is what the last presented frame drew of it.
+     */
+    ParticleSystem& getParticles();
+    ParticleBatch& getParticleBatch();
+
+    /*
+     * draw the default world through a camera: its (x, y) is the world position shown at the top-left
+     * of the visible area. main() reads it after the update function each frame, so move it from there
+     * (e.g. with Camera::follow). the camera isn't owned by the engine; pass null to go back to no offset.
+     */
+    void setCamera(Camera* camera);
+    Camera* getCamera();
+
+    /*
+     * pipeline rendering with simulation (off by default; set before calling main()).
+     *
+     * main() then runs each frame's physics, Entity::update and update function on a simulation thread
+     * that records the entities' draws into a command buffer, while the main thread, which owns the renderer,
+     * presents the previous frame's buffer. a slow present or vsync wait no longer holds up the simulation,
+     * at the cost of one frame of display latency.
+     *
+     * events and Input are still handled on the main thread between frames, but while it's on:
+     *     - the update functions run off the main thread, so they must not call SDL video/render functions
+     *       (create textures up front instead) or destroy textures that were drawn the frame before.
+     *     - the overlay renderer runs while the next frame simulates, so it should only read thread-safe state.
+     *     - the simulation thread's profiler phases are merged into the main thread's frame (see
+     *       Profiler::setHelperThread). the two threads overlap, so the per-phase times can add up to more
+     *       than the frame's wall time.
+     */
+    void setPipelinedRendering(bool pipelined);
+    bool isPipelinedRendering();
+
+    /*
+     * switch main() (the default world) to fixed-timestep simulation.
+     *
+     * physics and Entity::update run exactly `hz` times per simulated second, driven by an accumulator
+     * fed with the real frame time, and at most `maxSteps` times per frame (any backlog beyond that is dropped
+     * so a long hitch can't snowball). entities are drawn interpolated between their last two simulated positions.
+     *
+     * the update function passed to main() still runs once per frame with the frame delta;
+     * use setFixedUpdate() for game logic that has to run in lock-step with physics.
+     *
+     * pass hz <= 0 to return to the default of one variable-length step per frame.
+     */
+    void setFixedTimestep(float hz, int maxSteps = 5);
+
+    /*
+     * length of one fixed step in seconds, or 0 if fixed-timestep mode is off.
+     */
+    float getFixedTimestep();
+
+    /*
+     * how far the current frame is between the previous and the current simulation step, in [0, 1].
+     * always 1 when fixed-timestep mode is off.
+     */
+    float getInterpolationAlpha();
+
+    /*
+     * true while main() is running a fixed simulation step.
+     */
+    bool inFixedStep();
+
+    /*
+     * Optional callback invoked once per fixed step, after physics and Entity::update.
+     * receives the fixed step length in seconds. only used in fixed-timestep mode.
+     */
+    using FixedUpdate = void (*)(float);
+    void setFixedUpdate(FixedUpdate update);
+
+    /*
+     * run the default world's physics and parallel entity updates (see Entity::setParallelUpdate)
+     * on a pool of `threads` worker threads plus the main thread. 0 returns to single-threaded stepping.
+     * see World::setJobSystem for the ordering guarantees.
+     */
+    void setWorkerThreads(int threads);
+
 }
@@ -2,13 +2,27 @@
 
 
 #include "core.h"
+#include "world.h"
 #include "vec2.h"
 #include "entity.h"
 #include "physics.h"
 #include "input.h"
 #include "collision.h"
 #include "scaling.h"
+#include "sprite_batch.h"
+#include "spatial_hash.h"
+#include "sweep_prune.h"
+#include "aabb_tree.h"
+#include "static_layers.h"
+#include "particles.h"
+#include "camera.h"
+#include "atlas.h"
+#include "text.h"
+#include "asset_pack.h"
+#include "texture_cache.h"
 #include "timeline.h"
+#include "profiler.h"
+#include "trace.h"
 #include "memory/MemoryManager.hpp"
 
 
@@ -1,87 +1,222 @@
 #include "entity.h"
 #include "core.h"
 #include "scaling.h"
+#include "world.h"
+#include "texture_cache.h"
 #include <SDL3/SDL.h>
-#include <SDL3_image/SDL_image.h>
+#include <typeinfo>
 
 namespace Engine {
 
-    Entity::Entity(SDL_Texture* texture) {
-        this->texture = texture;
-
+    Entity::Entity(SDL_Texture* texture, World* world) {
+        this->world = world ? world : &defaultWorld();
         registerEntity(this);
+
+        setTexture(texture);
     };
 
-    Entity::Entity(const char* filePath) {
+    Entity::Entity(const char* filePath, World* world) {
+        this->world = world ? world : &defaultWorld();
+        registerEntity(this);
+
+        if (HEADLESS) {
+            // no renderer to upload to; only keep the image's extents.
+            int w, h;
+            if (Textures::getImageSize(filePath, w, h)) {
+                setSize((float)w, (float)h);
+            } else {
+                SDL_Log("failed to load image: %s", SDL_GetError());
+            }
+            return;
+        }
+
         if (!renderer)
             SDL_Log("Renderer is invalid! make sure to call Engine::init() before creating entities.");
-        texture = IMG_LoadTexture(renderer, filePath);
-        if (!texture)
-            SDL_Log("failed to load texture: %s", SDL_GetError());
 
+        TextureRegion region = Textures::acquire(filePath);
+        setRegion(region);
+        ownsRegion = (bool)region;
+    };
+
+    Entity::Entity(float width, float height, World* world) {
+        this->world = world ? world : &defaultWorld();
         registerEntity(this);
+
+        setSize(width, height);
     };
 
     Entity::~Entity() {
         unregisterEntity(this);
+        if (ownsRegion) Textures::release(getRegion());
     };
 
     void Entity::update(float dt) {
+        // nothing to do for a plain Entity, so stop visiting it. subclasses stay on the list.
+        if (typeid(*this) == typeid(Entity))
+            world->setInPhase(this, parallelUpdate ? World::PARALLEL_UPDATE : World::UPDATE, false);
+    }
 
+    void Entity::setParallelUpdate(bool p) {
+        if (p == parallelUpdate) return;
+
+        // only move lists if the entity is still on one; plain Entities may have dropped off already.
+        bool listed = phaseIndex[World::UPDATE] != EntityHandle::INVALID ||
+                      phaseIndex[World::PARALLEL_UPDATE] != EntityHandle::INVALID;
+        parallelUpdate = p;
+        if (listed) {
+            world->setInPhase(this, World::UPDATE, !p);
+            world->setInPhase(this, World::PARALLEL_UPDATE, p);
+        }
     }
 
-    void Entity::draw() {
+    void Entity::setPhysics(bool p) {
+        world->setPhysics(this, p);
+    }
 
+    void Entity::setCollisions(bool c) {
+        kin().set(index, Kinematics::COLLISIONS, c);
+        world->setInPhase(this, World::COLLIDE, c);
+    }
 
+    void Entity::setTexture(SDL_Texture* t) {
+        if (ownsRegion) Textures::release(getRegion());
+        ownsRegion = false;
+        textureTicket++;
+        texture = t;
+        hasSrc = false;
+        updateExtents();
+        world->setInPhase(this, World::DRAW, t != nullptr);
+    }
 
+    void Entity::setRegion(const TextureRegion& region) {
+        setTexture(region.texture);
+        if (!region) return;
+        src = region.src;
+        hasSrc = true;
+        updateExtents();
+    }
 
-        SDL_FRect srcRect = { /* x(position), y(position), width, height */
-            0.0f,
-            0.0f,
-            (float)texture->w,
-            (float)texture->h
-        };
+    void Entity::setTextureAsync(const std::string& path, int w, int h, std::function<void(Entity*)> onReady) {
+        setRegion(Textures::placeholder());
+        if (w > 0 && h > 0) setSize((float)w, (float)h);
+
+        Textures::acquireAsync(path, w, h, [world = world, handle = handle, ticket = textureTicket, onReady](const TextureRegion& region) {
+            Entity* e = world->get(handle);
+            if (!e || e->textureTicket != ticket) {
+                Textures::release(region);
+                return;
+            }
+            if (!region) return;
+
+            e->setRegion(region);
+            e->ownsRegion = true;
+            if (onReady) onReady(e);
+        });
+    }
+
+    TextureRegion Entity::getRegion() {
+        if (!texture) return {};
+        if (hasSrc) return {texture, src};
+        return {texture, {0, 0, (float)texture->w, (float)texture->h}};
+    }
 
+    void Entity::setTint(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+        tint = {r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f};
+        hasTint = true;
+        // static entities are cached with their tint baked in.
+        world->markDrawMoved(index);
+    }
 
-        SDL_FRect dstRect = Scaling::apply(getBoundingBox());
+    void Entity::updateExtents() {
+        float textureW = hasSrc ? src.w : (texture ? (float)texture->w : 0.0f);
+        float textureH = hasSrc ? src.h : (texture ? (float)texture->h : 0.0f);
+        kin().width[index] = size.x >= 0 ? size.x : textureW;
+        kin().height[index] = size.y >= 0 ? size.y : textureH;
+        world->markMoved(index);
+    }
 
+    SDL_FRect Entity::getDrawBox() {
+        SDL_FRect box = getBoundingBox();
+        float alpha = world->getInterpolationAlpha();
+        if (alpha < 1.0f) {
+            Kinematics& k = kin();
+            box.x = k.prevX[index] + (k.x[index] - k.prevX[index]) * alpha;
+            box.y = k.prevY[index] + (k.y[index] - k.prevY[index]) * alpha;
+        }
+        return box;
+    }
+
+    void Entity::draw() {
+        if (!renderer || !texture) return;
+
+        SDL_FRect srcRect = getRegion().src;
+        SDL_FRect dstRect = Scaling::apply(getDrawBox());
+
+        if (!hasTint) {
+            SDL_RenderTexture(renderer, texture, &srcRect, &dstRect);
+            return;
+        }
+
+        float r, g, b, a;
+        SDL_GetTextureColorModFloat(texture, &r, &g, &b);
+        SDL_GetTextureAlphaModFloat(texture, &a);
+        SDL_SetTextureColorModFloat(texture, tint.r, tint.g, tint.b);
+        SDL_SetTextureAlphaModFloat(texture, tint.a);
         SDL_RenderTexture(renderer, texture, &srcRect, &dstRect);
+        SDL_SetTextureColorModFloat(texture, r, g, b);
+        SDL_SetTextureAlphaModFloat(texture, a);
     };
 
+    void Entity::draw(SpriteBatch& batch) {
+        if (!texture) return;
+        const SDL_FRect* region = hasSrc ? &src : nullptr;
+        SDL_FRect box = staticDraw ? getBoundingBox() : getDrawBox();
+        if (hasTint) batch.draw(texture, region, box, layer, tint);
+        else batch.draw(texture, region, box, layer);
+    }
+
     void Entity::setPos(float x, float y) {
-        pos.x = x;
-        pos.y = y;
+        setPosX(x);
+        setPosY(y);
     };
 
     void Entity::setPos(Vec2& newPos) {
-        pos.x = newPos.x;
-        pos.y = newPos.y;
+        setPos(newPos.x, newPos.y);
     };
 
+    void Entity::setPosX(float x) {
+        kin().x[index] = x;
+        if (!world->inFixedStep()) kin().prevX[index] = x;
+        world->markMoved(index);
+    }
+
+    void Entity::setPosY(float y) {
+        kin().y[index] = y;
+        if (!world->inFixedStep()) kin().prevY[index] = y;
+        world->markMoved(index);
+    }
+
     void Entity::translate(float x, float y) {
-        pos.x += x;
-        pos.y += y;
+        Kinematics& k = kin();
+        k.x[index] += x;
+        k.y[index] += y;
+        if (!world->inFixedStep()) {
+            k.prevX[index] += x;
+            k.prevY[index] += y;
+        }
+        world->markMoved(index);
     };
 
     void Entity::translate(Vec2& delta) {
-        pos.x += delta.x;
-        pos.y += delta.y;
+        translate(delta.x, delta.y);
     };
 
     SDL_FRect Entity::getBoundingBox() {
         return { /* x(position), y(position), width, height */
-            pos.x,
-            pos.y,
+            getPosX(),
+            getPosY(),
             getWidth(),
             getHeight()
         };
     }
-
-    float Entity::getWidth() {
-        return (float)texture->w;
-    }
-
-    float Entity::getHeight() {
-        return (float)texture->h;
-    }
 }
@@ -1,54 +1,99 @@
 #pragma once
 #include "vec2.h"
+#include "world.h"
+#include "sprite_batch.h"
+#include "atlas.h"
 #include <SDL3/SDL_rect.h>
 #include <SDL3/SDL_render.h>
+#include <functional>
 #include <string>
 
 namespace Engine {
     class Entity {
+        friend class World;
+
         private:
             /*
-             * position of the entity
+             * the world this entity lives in.
              */
-            Vec2 pos = {0, 0};
+            World* world;
 
             /*
-             * velocity of the entity
+             * position in the world's entity list, and this entity's handle. maintained by the world.
              */
-            Vec2 vel = {0, 0};
+            uint32_t index = EntityHandle::INVALID;
+            EntityHandle handle;
 
             /*
-             * entity's texture for drawing
+             * position in each of the world's phase lists (see World::Phase). maintained by the world.
              */
-            SDL_Texture* texture;
+            uint32_t phaseIndex[World::PHASE_COUNT] = {EntityHandle::INVALID, EntityHandle::INVALID,
+                                                       EntityHandle::INVALID, EntityHandle::INVALID};
 
             /*
-             * whether the entity is affected by gravity.
+             * whether update() runs in the world's parallel update phase (see setParallelUpdate).
              */
-            bool gravity = false;
+            bool parallelUpdate = false;
 
             /*
-             * whether the entity has collisions:
-             *
-             * if false, (Entity::Collision::all()) will ignore this entity.
-             *
+             * entity's texture for drawing. may be null for entities without visuals (e.g. in headless mode).
+             */
+            SDL_Texture* texture = nullptr;
+
+            /*
+             * the part of the texture to draw (e.g. a sprite on an atlas page). only used when hasSrc is set;
+             * otherwise the whole texture is drawn.
+             */
+            SDL_FRect src = {0, 0, 0, 0};
+            bool hasSrc = false;
+
+            /*
+             * set when the texture came from Engine::Textures (the file path constructor), so it is released with the entity.
+             */
+            bool ownsRegion = false;
+
+            /*
+             * bumped by every texture change, so a setTextureAsync that has been superseded doesn't apply.
+             */
+            uint32_t textureTicket = 0;
+
+            /*
+             * per-entity color/alpha multiplier. without one, the texture's color and alpha mod apply.
+             */
+            SDL_FColor tint = {1, 1, 1, 1};
+            bool hasTint = false;
+
+            /*
+             * explicit width/height of the entity. negative values mean "use the texture size".
              */
-            bool collisions = true;
+            Vec2 size = {-1, -1};
 
             /*
-             * whether the entity has physics.
+             * draw layer (see setLayer).
              */
-            bool physics = true;
+            int layer = 0;
 
             /*
-             * friction applied to the object.
+             * drawn through the static layer cache rather than every frame (see setStatic). maintained by the world.
              */
-             Vec2 friction = {0, 0};
+            bool staticDraw = false;
+
             /*
-             * max speed applied to object. Note: (0, 0) is a special case where no
-             * maximum speed is applied to the object.
+             * bounding box at the current interpolation alpha, in game coordinates.
              */
-            Vec2 maxSpeed = {0, 0};
+            SDL_FRect getDrawBox();
+
+            /*
+             * position, velocity, friction, max speed, extents and flags live in the world's
+             * Kinematics arrays, in row `index`. these are shorthands for this entity's row.
+             */
+            Kinematics& kin() {return world->getKinematics();}
+            bool flag(uint8_t f) {return kin().has(index, f);}
+
+            /*
+             * recompute the cached width/height in the kinematics row from size and texture.
+             */
+            void updateExtents();
 
             std::string type = "Entity";
 
@@ -57,42 +102,121 @@ namespace Engine {
 
             /*
              * constructors. can pass the texture itself, or a file path to get the texture from.
+             * textures loaded from a path go through Engine::Textures, so entities using the same image share it.
              * position defaults to (0, 0).
+             * the entity is added to the given world, or to Engine::defaultWorld() if none is given.
+             */
+            Entity(SDL_Texture* texture, World* world = nullptr);
+            Entity(const char* filePath, World* world = nullptr);
+
+            /*
+             * texture-less entity with an explicit size. useful for invisible colliders and for headless mode.
+             */
+            Entity(float width, float height, World* world = nullptr);
+            virtual ~Entity();
+
+            /*
+             * get the world this entity belongs to.
+             */
+            World* getWorld() {return world;}
+
+            /*
+             * get a handle to this entity that can be safely kept after the entity is destroyed.
+             */
+            EntityHandle getHandle() {return handle;}
+
+            /*
+             * delete this entity at the end of the current frame. safe to call from update().
              */
-            Entity(SDL_Texture* texture);
-            Entity(const char* filePath);
-            ~Entity();
+            void destroy() {world->destroy(this);}
 
             /*
              * update function gets called automatically once per frame by the engine main loop.
              *
              * by default, it does nothing, but the idea is you could extend this class and override
              * this method to implement custom behavior.
+             * plain Entity instances are dropped from the world's update list after their first call.
              */
             virtual void update(float time);
 
+            /*
+             * opt this entity into the parallel update phase when the world has a job system (World::setJobSystem).
+             *
+             * update() may then run on a worker thread at the same time as other entities' updates. it may freely
+             * read and write this entity's own state (position, velocity, ...), and read entities that don't update
+             * in parallel, which nothing writes during the phase. it must not read other parallel entities: their
+             * updates may be writing them at that moment, a data race that also makes the result depend on the
+             * thread count. anything else, reads of other parallel entities included, has to go through
+             * getWorld()->defer(). destroy() and the physics/collision/texture setters are deferred automatically;
+             * creating or deleting entities and collision queries (Collision::all, pairs, at) are not, so defer
+             * those yourself.
+             */
+            void setParallelUpdate(bool p);
+            bool hasParallelUpdate() {return parallelUpdate;}
+
             /*
              * draw the entity to the screen.
+             * in fixed-timestep mode, the entity is drawn between its previous and current
+             * simulated position (see Engine::getInterpolationAlpha()).
              */
             void draw();
 
             /*
-             * set the position of the entity
+             * queue the entity into a sprite batch instead of drawing it immediately.
+             * this is how Engine::main() draws the DRAW phase.
+             */
+            void draw(SpriteBatch& batch);
+
+            /*
+             * get/set the draw layer. lower layers are drawn first; entities on the same layer
+             * may be drawn in any order relative to each other. defaults to 0.
+             */
+            int getLayer() {return layer;}
+            void setLayer(int l) {layer = l; world->markDrawMoved(index);}
+
+            /*
+             * mark the entity as static level geometry (off by default).
+             *
+             * Engine::main() then draws it into cached chunk textures (see StaticLayerCache) instead of queuing it
+             * every frame, and only redraws the chunks it covers when it moves, resizes, or changes texture, tint
+             * or layer. an entity that changes every frame just makes its chunks redraw every frame, so keep this
+             * for things that rarely do. static entities are drawn at their current position, without interpolation.
+             */
+            void setStatic(bool s) {world->setStatic(this, s);}
+            bool isStatic() {return staticDraw;}
+
+            /*
+             * set the position of the entity.
+             * outside of a fixed simulation step this counts as a teleport, so the entity
+             * is drawn exactly at the new position instead of being interpolated towards it.
              */
             void setPos(float x, float y);
             void setPos(Vec2& newPosition);
-            void setPosX(float x) {pos.x = x;}
-            void setPosY(float y) {pos.y = y;}
+            void setPosX(float x);
+            void setPosY(float y);
 
             /*
              * get the position of the entity
              */
-             Vec2& getPos() {return pos;}
-             float getPosX() {return pos.x;}
-             float getPosY() {return pos.y;}
+             Vec2 getPos() {return {getPosX(), getPosY()};}
+             float getPosX() {return kin().x[index];}
+             float getPosY() {return kin().y[index];}
+
+            /*
+             * get the position of the entity at the start of the last fixed simulation step.
+             */
+             Vec2 getPrevPos() {return {kin().prevX[index], kin().prevY[index]};}
+
+            /*
+             * remember the current position as the interpolation start point.
+             * the world copies every entity's previous position in bulk before each fixed step, so this is
+             * only needed when stepping an entity by hand.
+             */
+            void savePreviousPos() {kin().prevX[index] = kin().x[index]; kin().prevY[index] = kin().y[index];}
 
             /*
              * translate (move) the entity by the given amount.
+             * outside of a fixed simulation step the interpolation start point moves with it.
              */
             void translate(float x, float y);
             void translate(Vec2& delta);
@@ -100,66 +224,96 @@ namespace Engine {
             /*
              * check whether or not the entity is affected by gravity.
              */
-            bool hasGravity() {return gravity;}
+            bool hasGravity() {return flag(Kinematics::GRAVITY);}
 
             /*
              * enable or disable gravity on this entity.
              */
-            void setGravity(bool g) {gravity = g;}
+            void setGravity(bool g) {kin().set(index, Kinematics::GRAVITY, g);}
 
             /*
              * check whether or not the entity is collidable.
              */
-            bool hasCollisions() {return collisions;}
+            bool hasCollisions() {return flag(Kinematics::COLLISIONS);}
 
             /*
              * enable or disable collisions on this entity.
              */
-            void setCollisions(bool c) {collisions = c;}
+            void setCollisions(bool c);
 
             /*
              * check whether or not the entity is affected by physics.
              */
-            bool hasPhysics() {return physics;}
+            bool hasPhysics() {return flag(Kinematics::PHYSICS);}
 
             /*
              * enable or disable physics on this entity.
              */
-            void setPhysics(bool p) {physics = p;}
+            void setPhysics(bool p);
 
             /*
              * set the strength of friction in the x and y directions.
              */
-            void setFriction(float x, float y) {friction.x = x; friction.y = y;}
-            void setFriction(Vec2& fric) {friction.x = fric.x; friction.y = fric.y;}
+            void setFriction(float x, float y) {kin().frictionX[index] = x; kin().frictionY[index] = y;}
+            void setFriction(Vec2& fric) {setFriction(fric.x, fric.y);}
 
-            Vec2& getFriction() {return friction;}
+            Vec2 getFriction() {return {kin().frictionX[index], kin().frictionY[index]};}
 
             /*
              * set the max speed in the x and y directions.
              */
-            void setMaxSpeed(float x, float y) {maxSpeed.x = x; maxSpeed.y = y;}
-            void setMaxSpeed(Vec2& max) {maxSpeed.x = max.x; maxSpeed.y = max.y;}
+            void setMaxSpeed(float x, float y) {kin().maxSpeedX[index] = x; kin().maxSpeedY[index] = y;}
+            void setMaxSpeed(Vec2& max) {setMaxSpeed(max.x, max.y);}
 
-            Vec2& getMaxSpeed() {return maxSpeed;}
+            Vec2 getMaxSpeed() {return {kin().maxSpeedX[index], kin().maxSpeedY[index]};}
 
             /*
              * set the velocity of the entity
              */
-             void setVelocity(Vec2& velocity) {vel.x = velocity.x; vel.y = velocity.y;}
-             void setVelocity(float x, float y) {vel.x = x; vel.y = y;}
-             void setVelocityX(float x) {vel.x = x;}
-             void setVelocityY(float y) {vel.y = y;}
+             void setVelocity(Vec2& velocity) {setVelocity(velocity.x, velocity.y);}
+             void setVelocity(float x, float y) {kin().vx[index] = x; kin().vy[index] = y;}
+             void setVelocityX(float x) {kin().vx[index] = x;}
+             void setVelocityY(float y) {kin().vy[index] = y;}
 
-             Vec2& getVelocity() {return vel;}
-             float getVelocityX() {return vel.x;}
-             float getVelocityY() {return vel.y;}
+             Vec2 getVelocity() {return {getVelocityX(), getVelocityY()};}
+             float getVelocityX() {return kin().vx[index];}
+             float getVelocityY() {return kin().vy[index];}
 
             /*
              * apply a force (such as gravity, friction, or movement) to the entity
              */
-            void applyForce(Vec2& force) {vel.x += force.x; vel.y += force.y;}
-            void applyForce(float x, float y) {vel.x += x; vel.y += y;}
+            void applyForce(Vec2& force) {applyForce(force.x, force.y);}
+            void applyForce(float x, float y) {kin().vx[index] += x; kin().vy[index] += y;}
+
+            /*
+             * get/set the texture used to draw the entity. entities without a texture aren't drawn.
+             */
+            SDL_Texture* getTexture() {return texture;}
+            void setTexture(SDL_Texture* t);
+
+            /*
+             * draw a rectangle of a texture rather than all of it, e.g. a region from Engine::Textures::acquire()
+             * or an AtlasPacker. the entity's size defaults to the region's size.
+             * the entity doesn't take a reference; release acquired regions yourself once nothing draws them.
+             */
+            void setRegion(const TextureRegion& region);
+            TextureRegion getRegion();
+
+            /*
+             * load the image at `path` through Engine::Textures::acquireAsync, drawing the placeholder until it's ready.
+             * with both w and h given the entity gets that size right away; otherwise it takes the image's size on load.
+             * onReady (optional) runs on the main thread once the real texture is in place.
+             * the texture is released with the entity. safe to call from any thread, including a pipelined update.
+             */
+            void setTextureAsync(const std::string& path, int w = 0, int h = 0, std::function<void(Entity*)> onReady = nullptr);
+
+            /*
+             * multiply the entity's color and alpha, like SDL_SetTextureColorMod/AlphaMod but without affecting
+             * other entities using the same texture (or atlas page). clearTint goes back to the texture's own mods.
+             */
+            void setTint(Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+            void clearTint() {hasTint = false; world->markDrawMoved(index);}
+            bool getTint(SDL_FColor& color) {color = tint; return hasTint;}
 
             /*
              * get the bounding box of the entity.
@@ -169,8 +323,14 @@ namespace Engine {
             /*
              * get the width/height of the entity.
              */
-            float getWidth();
-            float getHeight();
+            float getWidth() {return kin().width[index];}
+            float getHeight() {return kin().height[index];}
+
+            /*
+             * override the width/height of the entity instead of taking them from its texture.
+             * the texture (if any) is stretched to fit when drawn.
+             */
+            void setSize(float w, float h) {size.x = w; size.y = h; updateExtents();}
 
             /*
              * get the self-defined type string of this entity.
@@ -1,6 +1,7 @@
 #include "event_manager.h"
 #include "events.h"
 #include "replay_manager.h"
+#include "trace.h"
 #include <algorithm>
 
 namespace Engine {
@@ -70,6 +71,7 @@ namespace Engine {
     }
 
     void EventManager::dispatch(const std::string& eventType, std::shared_ptr<Event> event) {
+        TRACE_SCOPE("EventManager::dispatch");
         auto it = typeToHandlers.find(eventType);
         if (it != typeToHandlers.end()) {
             // Call all registered handlers for this event type
@@ -7,16 +7,30 @@
 
 namespace Engine {
 
-    // Collision Event
+    // Collision Event - raised by World when two entities start ("collision_enter") or stop
+    // ("collision_exit") touching; see World::setContactEvents. entity1/entity2 are in no particular
+    // order, and an exit's entity is null if it was deleted in the meantime.
     class CollisionEvent : public Event {
     public:
+        enum Contact { ENTER, EXIT };
+
         Entity* entity1;
         Entity* entity2;
-        
-        CollisionEvent(Entity* e1, Entity* e2) 
-            : entity1(e1), entity2(e2) {}
-        
-        std::string getType() const override { return "collision"; }
+        Contact contact;
+
+        CollisionEvent(Entity* e1, Entity* e2, Contact c = ENTER)
+            : entity1(e1), entity2(e2), contact(c) {}
+
+        bool involves(const Entity* e) const { return e && (entity1 == e || entity2 == e); }
+
+        // the other entity of the pair, or null if e isn't in it
+        Entity* other(const Entity* e) const {
+            if (e && entity1 == e) return entity2;
+            if (e && entity2 == e) return entity1;
+            return nullptr;
+        }
+
+        std::string getType() const override { return contact == ENTER ? "collision_enter" : "collision_exit"; }
     };
 
     // Death Event
@@ -0,0 +1,222 @@
+#include "integrator.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Engine::Integrate {
+
+    /*
+     * same as Physics::clamps.
+     */
+    static inline float clamps(float value, float max) {
+        return std::copysignf(std::min(std::abs(value), max), value);
+    }
+
+    void scalar(Kinematics& k, size_t begin, size_t end, const Params& p) {
+        float* x = k.x.data();
+        float* y = k.y.data();
+        float* vx = k.vx.data();
+        float* vy = k.vy.data();
+
+        for (size_t i = begin; i < end; i++) {
+            if (k.flags[i] & Kinematics::GRAVITY) vy[i] += p.gravityDt;
+
+            vx[i] -= clamps(vx[i], k.frictionX[i] * p.dt);
+            vy[i] -= clamps(vy[i], k.frictionY[i] * p.dt);
+
+            if (k.maxSpeedX[i] > 0) vx[i] = clamps(vx[i], k.maxSpeedX[i]);
+            if (k.maxSpeedY[i] > 0) vy[i] = clamps(vy[i], k.maxSpeedY[i]);
+
+            float dx = vx[i] * p.dt;
+            float dy = vy[i] * p.dt;
+            x[i] += dx;
+            y[i] += dy;
+            if (p.dragPrev) {
+                k.prevX[i] += dx;
+                k.prevY[i] += dy;
+            }
+        }
+    }
+
+#if ENGINE_X86
+
+    /*
+     * lane-wise clamps(). min(max, |v|) picks the same operand as std::min(|v|, max), NaNs included.
+     */
+    ENGINE_TARGET_SSE2 static inline __m128 clamps4(__m128 v, __m128 max) {
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        __m128 m = _mm_min_ps(max, _mm_andnot_ps(sign, v));
+        return _mm_or_ps(_mm_andnot_ps(sign, m), _mm_and_ps(sign, v));
+    }
+
+    ENGINE_TARGET_SSE2 static inline __m128 select4(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    ENGINE_TARGET_AVX2 static inline __m256 clamps8(__m256 v, __m256 max) {
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+        __m256 m = _mm256_min_ps(max, _mm256_andnot_ps(sign, v));
+        return _mm256_or_ps(_mm256_andnot_ps(sign, m), _mm256_and_ps(sign, v));
+    }
+
+    ENGINE_TARGET_SSE2 void sse2(Kinematics& k, size_t begin, size_t end, const Params& p) {
+        float* x = k.x.data();
+        float* y = k.y.data();
+        float* vx = k.vx.data();
+        float* vy = k.vy.data();
+        float* prevX = k.prevX.data();
+        float* prevY = k.prevY.data();
+        const float* fx = k.frictionX.data();
+        const float* fy = k.frictionY.data();
+        const float* mx = k.maxSpeedX.data();
+        const float* my = k.maxSpeedY.data();
+        const uint8_t* flags = k.flags.data();
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 dt = _mm_set1_ps(p.dt);
+        const __m128 g = _mm_set1_ps(p.gravityDt);
+        const __m128i gravityBit = _mm_set1_epi32(Kinematics::GRAVITY);
+
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            __m128 vxs = _mm_loadu_ps(vx + i);
+            __m128 vys = _mm_loadu_ps(vy + i);
+
+            // widen 4 flag bytes to 4 lanes and test the gravity bit.
+            int32_t bytes;
+            std::memcpy(&bytes, flags + i, sizeof(bytes));
+            __m128i f = _mm_cvtsi32_si128(bytes);
+            f = _mm_unpacklo_epi8(f, _mm_setzero_si128());
+            f = _mm_unpacklo_epi16(f, _mm_setzero_si128());
+            __m128 gravity = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, gravityBit), gravityBit));
+            vys = select4(gravity, _mm_add_ps(vys, g), vys);
+
+            vxs = _mm_sub_ps(vxs, clamps4(vxs, _mm_mul_ps(_mm_loadu_ps(fx + i), dt)));
+            vys = _mm_sub_ps(vys, clamps4(vys, _mm_mul_ps(_mm_loadu_ps(fy + i), dt)));
+
+            __m128 maxX = _mm_loadu_ps(mx + i);
+            __m128 maxY = _mm_loadu_ps(my + i);
+            vxs = select4(_mm_cmpgt_ps(maxX, zero), clamps4(vxs, maxX), vxs);
+            vys = select4(_mm_cmpgt_ps(maxY, zero), clamps4(vys, maxY), vys);
+
+            _mm_storeu_ps(vx + i, vxs);
+            _mm_storeu_ps(vy + i, vys);
+
+            __m128 dx = _mm_mul_ps(vxs, dt);
+            __m128 dy = _mm_mul_ps(vys, dt);
+            _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), dx));
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), dy));
+            if (p.dragPrev) {
+                _mm_storeu_ps(prevX + i, _mm_add_ps(_mm_loadu_ps(prevX + i), dx));
+                _mm_storeu_ps(prevY + i, _mm_add_ps(_mm_loadu_ps(prevY + i), dy));
+            }
+        }
+
+        scalar(k, i, end, p);
+    }
+
+    ENGINE_TARGET_AVX2 void avx2(Kinematics& k, size_t begin, size_t end, const Params& p) {
+        float* x = k.x.data();
+        float* y = k.y.data();
+        float* vx = k.vx.data();
+        float* vy = k.vy.data();
+        float* prevX = k.prevX.data();
+        float* prevY = k.prevY.data();
+        const float* fx = k.frictionX.data();
+        const float* fy = k.frictionY.data();
+        const float* mx = k.maxSpeedX.data();
+        const float* my = k.maxSpeedY.data();
+        const uint8_t* flags = k.flags.data();
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 dt = _mm256_set1_ps(p.dt);
+        const __m256 g = _mm256_set1_ps(p.gravityDt);
+        const __m256i gravityBit = _mm256_set1_epi32(Kinematics::GRAVITY);
+
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m256 vxs = _mm256_loadu_ps(vx + i);
+            __m256 vys = _mm256_loadu_ps(vy + i);
+
+            __m256i f = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(flags + i)));
+            __m256 gravity = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(f, gravityBit), gravityBit));
+            vys = _mm256_blendv_ps(vys, _mm256_add_ps(vys, g), gravity);
+
+            vxs = _mm256_sub_ps(vxs, clamps8(vxs, _mm256_mul_ps(_mm256_loadu_ps(fx + i), dt)));
+            vys = _mm256_sub_ps(vys, clamps8(vys, _mm256_mul_ps(_mm256_loadu_ps(fy + i), dt)));
+
+            __m256 maxX = _mm256_loadu_ps(mx + i);
+            __m256 maxY = _mm256_loadu_ps(my + i);
+            vxs = _mm256_blendv_ps(vxs, clamps8(vxs, maxX), _mm256_cmp_ps(maxX, zero, _CMP_GT_OQ));
+            vys = _mm256_blendv_ps(vys, clamps8(vys, maxY), _mm256_cmp_ps(maxY, zero, _CMP_GT_OQ));
+
+            _mm256_storeu_ps(vx + i, vxs);
+            _mm256_storeu_ps(vy + i, vys);
+
+            __m256 dx = _mm256_mul_ps(vxs, dt);
+            __m256 dy = _mm256_mul_ps(vys, dt);
+            _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), dx));
+            _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), dy));
+            if (p.dragPrev) {
+                _mm256_storeu_ps(prevX + i, _mm256_add_ps(_mm256_loadu_ps(prevX + i), dx));
+                _mm256_storeu_ps(prevY + i, _mm256_add_ps(_mm256_loadu_ps(prevY + i), dy));
+            }
+        }
+
+        scalar(k, i, end, p);
+    }
+
+    static bool detectSSE2() {
+    #if defined(__x86_64__) || defined(_M_X64)
+        return true;
+    #elif defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+    #else
+        return __builtin_cpu_supports("sse2");
+    #endif
+    }
+
+    static bool detectAVX2() {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+
+        // the cpu has to support AVX and the OS has to save the ymm registers (OSXSAVE + XCR0 bits 1 and 2).
+        __cpuid(info, 1);
+        const int osxsave = 1 << 27, avx = 1 << 28;
+        if ((info[2] & (osxsave | avx)) != (osxsave | avx)) return false;
+        if ((_xgetbv(0) & 6) != 6) return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        // also checks that the OS enabled the ymm state.
+        return __builtin_cpu_supports("avx2");
+    #endif
+    }
+
+    bool hasSSE2() {
+        static const bool supported = detectSSE2();
+        return supported;
+    }
+
+    bool hasAVX2() {
+        static const bool supported = detectAVX2();
+        return supported;
+    }
+
+#else
+
+    // no vector kernels on this architecture; Physics never selects them.
+    void sse2(Kinematics& k, size_t begin, size_t end, const Params& p) {scalar(k, begin, end, p);}
+    void avx2(Kinematics& k, size_t begin, size_t end, const Params& p) {scalar(k, begin, end, p);}
+    bool hasSSE2() {return false;}
+    bool hasAVX2() {return false;}
+
+#endif
+}
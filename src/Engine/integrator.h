@@ -0,0 +1,38 @@
+#pragma once
+#include "kinematics.h"
+#include <cstddef>
+
+/*
+ * batch physics kernels over a range of Kinematics rows, used by Physics::step.
+ * every kernel produces bit-for-bit the same result as Physics::apply on each row;
+ * pick one with Physics::setIntegrator rather than calling these directly.
+ */
+namespace Engine::Integrate {
+
+    struct Params {
+        /*
+         * step length in seconds.
+         */
+        float dt;
+
+        /*
+         * velocity change from gravity over this step (gravity * dt).
+         */
+        float gravityDt;
+
+        /*
+         * also move the interpolation start point (true outside a fixed step, see Entity::translate).
+         */
+        bool dragPrev;
+    };
+
+    void scalar(Kinematics& k, size_t begin, size_t end, const Params& p);
+    void sse2(Kinematics& k, size_t begin, size_t end, const Params& p);
+    void avx2(Kinematics& k, size_t begin, size_t end, const Params& p);
+
+    /*
+     * whether the kernel is compiled in and the cpu (and OS) can run it.
+     */
+    bool hasSSE2();
+    bool hasAVX2();
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Engine {
+
+    /*
+     * structure-of-arrays storage for the hot per-entity data of a world.
+     *
+     * row i belongs to World::getEntities()[i]; the Entity accessors read and write through to it.
+     * rows with physics enabled are kept at the front (see World::getPhysicsCount()), so the physics
+     * pass streams through contiguous arrays instead of chasing Entity pointers.
+     */
+    struct Kinematics {
+        /*
+         * bits of the per-row flags byte.
+         */
+        static constexpr uint8_t GRAVITY = 1 << 0;
+        static constexpr uint8_t PHYSICS = 1 << 1;
+        static constexpr uint8_t COLLISIONS = 1 << 2;
+
+        /*
+         * set when the row's entity changes in a way one of the world's indexes has to catch up with, and cleared
+         * by that index once it has:
+         *     DRAW_MOVED    - position or extents changed outside of physics, or the entity's look changed
+         *                     (texture, tint, layer); see World::queryDrawable
+         *     COLLIDE_MOVED - position or extents changed outside of physics; see World::queryCollidable
+         * MOVED is both. set them through World::markMoved / markDrawMoved, which also tell the world to look for them.
+         */
+        static constexpr uint8_t DRAW_MOVED = 1 << 3;
+        static constexpr uint8_t COLLIDE_MOVED = 1 << 4;
+        static constexpr uint8_t MOVED = DRAW_MOVED | COLLIDE_MOVED;
+
+        std::vector<float> x, y;
+        std::vector<float> prevX, prevY;
+        std::vector<float> vx, vy;
+        std::vector<float> frictionX, frictionY;
+        std::vector<float> maxSpeedX, maxSpeedY;
+        std::vector<float> width, height;
+        std::vector<uint8_t> flags;
+
+        size_t size() const {return x.size();}
+
+        /*
+         * append a row for a new entity: at rest at (0, 0), no size, physics and collisions on.
+         */
+        void push() {
+            x.push_back(0); y.push_back(0);
+            prevX.push_back(0); prevY.push_back(0);
+            vx.push_back(0); vy.push_back(0);
+            frictionX.push_back(0); frictionY.push_back(0);
+            maxSpeedX.push_back(0); maxSpeedY.push_back(0);
+            width.push_back(0); height.push_back(0);
+            flags.push_back(PHYSICS | COLLISIONS);
+        }
+
+        void pop() {
+            x.pop_back(); y.pop_back();
+            prevX.pop_back(); prevY.pop_back();
+            vx.pop_back(); vy.pop_back();
+            frictionX.pop_back(); frictionY.pop_back();
+            maxSpeedX.pop_back(); maxSpeedY.pop_back();
+            width.pop_back(); height.pop_back();
+            flags.pop_back();
+        }
+
+        void swap(size_t a, size_t b) {
+            std::swap(x[a], x[b]); std::swap(y[a], y[b]);
+            std::swap(prevX[a], prevX[b]); std::swap(prevY[a], prevY[b]);
+            std::swap(vx[a], vx[b]); std::swap(vy[a], vy[b]);
+            std::swap(frictionX[a], frictionX[b]); std::swap(frictionY[a], frictionY[b]);
+            std::swap(maxSpeedX[a], maxSpeedX[b]); std::swap(maxSpeedY[a], maxSpeedY[b]);
+            std::swap(width[a], width[b]); std::swap(height[a], height[b]);
+            std::swap(flags[a], flags[b]);
+        }
+
+        bool has(size_t row, uint8_t flag) const {return (flags[row] & flag) != 0;}
+
+        void set(size_t row, uint8_t flag, bool on) {
+            if (on) flags[row] |= flag;
+            else flags[row] &= (uint8_t)~flag;
+        }
+    };
+}
@@ -0,0 +1,309 @@
+#include "particles.h"
+#include "physics.h"
+#include "simd.h"
+#include "trace.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+
+    /*
+     * one update's worth of motion, shared by every particle of a pool.
+     */
+    struct ParticleStep {
+        float dt;
+        float gravityDt;    // velocity change from gravity over the step
+        float damping;      // velocity kept over the step, from the emitter's drag
+    };
+
+    /*
+     * the update kernels: move particles [begin, end) of a pool. they all do the same float operations in the same
+     * order (no fused multiply-adds), so every kernel gives the same result.
+     */
+    static void stepScalar(float* x, float* y, float* vx, float* vy, float* age, size_t begin, size_t end, const ParticleStep& p) {
+        for (size_t i = begin; i < end; i++) {
+            vy[i] += p.gravityDt;
+            vx[i] *= p.damping;
+            vy[i] *= p.damping;
+            x[i] += vx[i] * p.dt;
+            y[i] += vy[i] * p.dt;
+            age[i] += p.dt;
+        }
+    }
+
+#if ENGINE_X86
+
+    ENGINE_TARGET_SSE2 static void stepSSE2(float* x, float* y, float* vx, float* vy, float* age, size_t begin, size_t end, const ParticleStep& p) {
+        const __m128 dt = _mm_set1_ps(p.dt);
+        const __m128 g = _mm_set1_ps(p.gravityDt);
+        const __m128 damping = _mm_set1_ps(p.damping);
+
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            __m128 vxs = _mm_mul_ps(_mm_loadu_ps(vx + i), damping);
+            __m128 vys = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vy + i), g), damping);
+            _mm_storeu_ps(vx + i, vxs);
+            _mm_storeu_ps(vy + i, vys);
+            _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(vxs, dt)));
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(vys, dt)));
+            _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), dt));
+        }
+
+        stepScalar(x, y, vx, vy, age, i, end, p);
+    }
+
+    ENGINE_TARGET_AVX2 static void stepAVX2(float* x, float* y, float* vx, float* vy, float* age, size_t begin, size_t end, const ParticleStep& p) {
+        const __m256 dt = _mm256_set1_ps(p.dt);
+        const __m256 g = _mm256_set1_ps(p.gravityDt);
+        const __m256 damping = _mm256_set1_ps(p.damping);
+
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m256 vxs = _mm256_mul_ps(_mm256_loadu_ps(vx + i), damping);
+            __m256 vys = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(vy + i), g), damping);
+            _mm256_storeu_ps(vx + i, vxs);
+            _mm256_storeu_ps(vy + i, vys);
+            _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(vxs, dt)));
+            _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(vys, dt)));
+            _mm256_storeu_ps(age + i, _mm256_add_ps(_mm256_loadu_ps(age + i), dt));
+        }
+
+        stepScalar(x, y, vx, vy, age, i, end, p);
+    }
+
+#else
+
+    static void stepSSE2(float* x, float* y, float* vx, float* vy, float* age, size_t begin, size_t end, const ParticleStep& p) {stepScalar(x, y, vx, vy, age, begin, end, p);}
+    static void stepAVX2(float* x, float* y, float* vx, float* vy, float* age, size_t begin, size_t end, const ParticleStep& p) {stepScalar(x, y, vx, vy, age, begin, end, p);}
+
+#endif
+
+    static float lerp(float a, float b, float t) {return a + (b - a) * t;}
+
+    void ParticleBatch::begin() {
+        vertices.clear();
+        runs.clear();
+    }
+
+    void ParticleBatch::flush(SDL_Renderer* renderer, const Scaling::Transform& transform) {
+        lastParticles = size();
+        lastDrawCalls = 0;
+        if (runs.empty() || !renderer) {
+            begin();
+            return;
+        }
+
+        TRACE_SCOPE("particle batch flush");
+        if (transform.sx != 1 || transform.sy != 1 || transform.tx != 0 || transform.ty != 0) {
+            for (SDL_Vertex& v : vertices) {
+                v.position.x = v.position.x * transform.sx + transform.tx;
+                v.position.y = v.position.y * transform.sy + transform.ty;
+            }
+        }
+
+        // indices are relative to the start of a run, so one list serves every run.
+        size_t longest = 0;
+        for (const Run& run : runs) longest = std::max(longest, run.count);
+        size_t built = indices.size() / 6;
+        if (built < longest) {
+            indices.resize(longest * 6);
+            for (size_t i = built; i < longest; i++) {
+                int base = (int)(i * 4);
+                int* q = &indices[i * 6];
+                q[0] = base; q[1] = base + 1; q[2] = base + 2;
+                q[3] = base + 2; q[4] = base + 3; q[5] = base;
+            }
+        }
+
+        for (const Run& run : runs) {
+            // untextured geometry is blended with the renderer's draw blend mode, textured with the texture's.
+            SDL_BlendMode previous = SDL_BLENDMODE_NONE;
+            if (run.texture) {
+                SDL_GetTextureBlendMode(run.texture, &previous);
+                if (previous != run.blend) SDL_SetTextureBlendMode(run.texture, run.blend);
+            } else {
+                SDL_GetRenderDrawBlendMode(renderer, &previous);
+                if (previous != run.blend) SDL_SetRenderDrawBlendMode(renderer, run.blend);
+            }
+
+            if (!SDL_RenderGeometry(renderer, run.texture, &vertices[run.first * 4], (int)(run.count * 4),
+                                    indices.data(), (int)(run.count * 6))) {
+                SDL_Log("Can't draw particles: %s", SDL_GetError());
+            }
+            lastDrawCalls++;
+
+            if (previous != run.blend) {
+                if (run.texture) SDL_SetTextureBlendMode(run.texture, previous);
+                else SDL_SetRenderDrawBlendMode(renderer, previous);
+            }
+        }
+
+        begin();
+    }
+
+    ParticleSystem::ParticleSystem(size_t capacity) : capacity(capacity) {}
+
+    size_t ParticleSystem::addEmitter(const ParticleEmitter& emitter) {
+        pools.emplace_back();
+        pools.back().emitter = emitter;
+        return pools.size() - 1;
+    }
+
+    void ParticleSystem::setEmitting(size_t emitter, bool emitting) {
+        pools[emitter].emitting = emitting;
+        pools[emitter].pending = 0;
+    }
+
+    void ParticleSystem::setEmitterPosition(size_t emitter, float x, float y) {
+        pools[emitter].emitX = x;
+        pools[emitter].emitY = y;
+    }
+
+    float ParticleSystem::random() {
+        // xorshift32; plenty for effects, and cheap enough to call several times per particle.
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    }
+
+    size_t ParticleSystem::burst(size_t emitter, float x, float y, size_t count) {
+        return spawn(pools[emitter], x, y, count);
+    }
+
+    size_t ParticleSystem::spawn(Pool& pool, float x, float y, size_t count) {
+        count = std::min(count, capacity - live);
+        if (count == 0) return 0;
+
+        const ParticleEmitter& e = pool.emitter;
+        size_t n = pool.x.size();
+        for (std::vector<float>* column : {&pool.x, &pool.y, &pool.vx, &pool.vy, &pool.age, &pool.invLife}) {
+            column->resize(n + count);
+        }
+
+        for (size_t i = n; i < n + count; i++) {
+            float angle = e.angle + (random() - 0.5f) * e.spread;
+            float speed = lerp(e.speedMin, e.speedMax, random());
+            float life = std::max(lerp(e.lifeMin, e.lifeMax, random()), 0.001f);
+            pool.x[i] = x + (random() - 0.5f) * 2.0f * e.jitter;
+            pool.y[i] = y + (random() - 0.5f) * 2.0f * e.jitter;
+            pool.vx[i] = std::cos(angle) * speed;
+            pool.vy[i] = std::sin(angle) * speed;
+            pool.age[i] = 0.0f;
+            pool.invLife[i] = 1.0f / life;
+        }
+
+        live += count;
+        return count;
+    }
+
+    void ParticleSystem::update(float dt) {
+        if (dt <= 0) return;
+        TRACE_SCOPE("particles");
+
+        Physics::Integrator kernel = Physics::getIntegrator();
+        for (Pool& pool : pools) {
+            size_t n = pool.x.size();
+            if (n > 0) {
+                ParticleStep p{dt, pool.emitter.gravity * dt, std::max(0.0f, 1.0f - pool.emitter.drag * dt)};
+                float* x = pool.x.data();
+                float* y = pool.y.data();
+                float* vx = pool.vx.data();
+                float* vy = pool.vy.data();
+                float* age = pool.age.data();
+                if (kernel == Physics::AVX2) stepAVX2(x, y, vx, vy, age, 0, n, p);
+                else if (kernel == Physics::SSE2) stepSSE2(x, y, vx, vy, age, 0, n, p);
+                else stepScalar(x, y, vx, vy, age, 0, n, p);
+
+                // retire dead particles by moving the last live one into their slot.
+                const float* invLife = pool.invLife.data();
+                for (size_t i = 0; i < n;) {
+                    if (age[i] * invLife[i] < 1.0f) {
+                        i++;
+                        continue;
+                    }
+                    n--;
+                    for (std::vector<float>* column : {&pool.x, &pool.y, &pool.vx, &pool.vy, &pool.age, &pool.invLife}) {
+                        (*column)[i] = (*column)[n];
+                    }
+                }
+                live -= pool.x.size() - n;
+                for (std::vector<float>* column : {&pool.x, &pool.y, &pool.vx, &pool.vy, &pool.age, &pool.invLife}) {
+                    column->resize(n);
+                }
+            }
+
+            if (pool.emitting && pool.emitter.rate > 0) {
+                pool.pending += pool.emitter.rate * dt;
+                size_t count = (size_t)pool.pending;
+                pool.pending -= (float)count;
+                spawn(pool, pool.emitX, pool.emitY, count);
+            }
+        }
+    }
+
+    void ParticleSystem::record(const SDL_FRect& view, ParticleBatch& out) const {
+        TRACE_SCOPE("record particles");
+        out.begin();
+        out.live = live;
+
+        float viewRight = view.x + view.w;
+        float viewBottom = view.y + view.h;
+
+        for (const Pool& pool : pools) {
+            size_t n = pool.x.size();
+            if (n == 0) continue;
+
+            const ParticleEmitter& e = pool.emitter;
+            float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+            // texture->w/h are plain fields, so this is safe off the render thread (see SpriteBatch::draw).
+            if (e.texture && e.src.w > 0 && e.src.h > 0 && e.texture->w > 0 && e.texture->h > 0) {
+                u0 = e.src.x / e.texture->w;
+                v0 = e.src.y / e.texture->h;
+                u1 = (e.src.x + e.src.w) / e.texture->w;
+                v1 = (e.src.y + e.src.h) / e.texture->h;
+            }
+
+            size_t first = out.vertices.size() / 4;
+            out.vertices.resize((first + n) * 4);
+            SDL_Vertex* v = &out.vertices[first * 4];
+
+            const float* x = pool.x.data();
+            const float* y = pool.y.data();
+            const float* age = pool.age.data();
+            const float* invLife = pool.invLife.data();
+            for (size_t i = 0; i < n; i++) {
+                float t = std::min(age[i] * invLife[i], 1.0f);
+                float half = lerp(e.sizeStart, e.sizeEnd, t) * 0.5f;
+                float x0 = x[i] - half, x1 = x[i] + half;
+                float y0 = y[i] - half, y1 = y[i] + half;
+                if (x1 < view.x || x0 > viewRight || y1 < view.y || y0 > viewBottom) continue;
+
+                SDL_FColor color{lerp(e.colorStart.r, e.colorEnd.r, t), lerp(e.colorStart.g, e.colorEnd.g, t),
+                                 lerp(e.colorStart.b, e.colorEnd.b, t), lerp(e.colorStart.a, e.colorEnd.a, t)};
+                v[0] = {{x0, y0}, color, {u0, v0}};
+                v[1] = {{x1, y0}, color, {u1, v0}};
+                v[2] = {{x1, y1}, color, {u1, v1}};
+                v[3] = {{x0, y1}, color, {u0, v1}};
+                v += 4;
+            }
+
+            size_t count = (size_t)(v - &out.vertices[first * 4]) / 4;
+            out.vertices.resize((first + count) * 4);
+            if (count > 0) out.runs.push_back({e.texture, e.blend, first, count});
+        }
+
+        TRACE_COUNTER("particles drawn", (double)out.size());
+    }
+
+    void ParticleSystem::clear() {
+        for (Pool& pool : pools) {
+            for (std::vector<float>* column : {&pool.x, &pool.y, &pool.vx, &pool.vy, &pool.age, &pool.invLife}) {
+                column->clear();
+            }
+            pool.pending = 0;
+        }
+        live = 0;
+    }
+}
@@ -0,0 +1,198 @@
+#pragma once
+#include "scaling.h"
+#include <SDL3/SDL_blendmode.h>
+#include <SDL3/SDL_pixels.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    /*
+     * what an emitter's particles look like and how they move. every particle of an emitter shares these;
+     * the ranges are sampled once per particle as it's spawned.
+     */
+    struct ParticleEmitter {
+        /*
+         * texture and source rect (in texture pixels) drawn for each particle. a null texture draws plain
+         * colored squares; a null src uses the whole texture.
+         */
+        SDL_Texture* texture = nullptr;
+        SDL_FRect src{0, 0, 0, 0};
+        SDL_BlendMode blend = SDL_BLENDMODE_BLEND;
+
+        /*
+         * lifetime in seconds, and launch speed in pixels per second.
+         */
+        float lifeMin = 0.5f, lifeMax = 1.0f;
+        float speedMin = 50.0f, speedMax = 200.0f;
+
+        /*
+         * launch direction in radians (0 is +x, pi/2 is down) and the width of the cone around it.
+         * the default sprays in every direction.
+         */
+        float angle = 0.0f;
+        float spread = 6.2831853f;
+
+        /*
+         * particles spawn up to this far from the emission point, in a square.
+         */
+        float jitter = 0.0f;
+
+        /*
+         * downward acceleration in pixels per second squared, and the fraction of velocity lost per second.
+         */
+        float gravity = 0.0f;
+        float drag = 0.0f;
+
+        /*
+         * side length in pixels and color at birth and at death, interpolated linearly over the lifetime.
+         */
+        float sizeStart = 8.0f, sizeEnd = 0.0f;
+        SDL_FColor colorStart{1.0f, 1.0f, 1.0f, 1.0f};
+        SDL_FColor colorEnd{1.0f, 1.0f, 1.0f, 0.0f};
+
+        /*
+         * particles per second spawned while the emitter is emitting (see ParticleSystem::setEmitting).
+         * bursts don't depend on it.
+         */
+        float rate = 0.0f;
+    };
+
+    /*
+     * one frame's particle quads, ready to submit: a vertex array plus one run per emitter that had
+     * particles in view. filled by ParticleSystem::record() and drawn by flush(), like a SpriteBatch,
+     * so it can be recorded on the simulation thread and flushed on the main thread.
+     */
+    class ParticleBatch {
+        public:
+            /*
+             * drop everything recorded since the last flush().
+             */
+            void begin();
+
+            /*
+             * submit everything recorded since begin(), one SDL_RenderGeometry call per run, then empty the batch.
+             * positions are mapped through `transform` (see SpriteBatch::flush).
+             */
+            void flush(SDL_Renderer* renderer, const Scaling::Transform& transform);
+
+            /*
+             * particles recorded since begin().
+             */
+            size_t size() const {return vertices.size() / 4;}
+
+            /*
+             * particles and SDL_RenderGeometry calls submitted by the last flush().
+             */
+            size_t getParticleCount() const {return lastParticles;}
+            size_t getDrawCalls() const {return lastDrawCalls;}
+
+            /*
+             * live particles in the system when it was recorded, on screen or not. a snapshot, so it can be read
+             * while the simulation thread updates the system (see Engine::setPipelinedRendering).
+             */
+            size_t getLiveCount() const {return live;}
+
+        private:
+            friend class ParticleSystem;
+
+            struct Run {
+                SDL_Texture* texture;
+                SDL_BlendMode blend;
+                size_t first, count;
+            };
+
+            std::vector<SDL_Vertex> vertices;
+            std::vector<Run> runs;
+            std::vector<int> indices;
+
+            size_t lastParticles = 0;
+            size_t lastDrawCalls = 0;
+            size_t live = 0;
+    };
+
+    /*
+     * pools of short-lived particles for effects (sparks, dust, bursts on death and respawn).
+     *
+     * each emitter keeps its particles in a structure-of-arrays pool (x, y, vx, vy, age, 1/lifetime), so update()
+     * streams through plain float arrays with the kernel Physics::setIntegrator picked (scalar, SSE2 or AVX2),
+     * and dead particles are swap-removed, so a pool stays dense. drawing builds every live particle's quad into
+     * a ParticleBatch, which draws each emitter with a single SDL_RenderGeometry call.
+     *
+     * Engine::main() updates getParticles() after the update function and draws it on top of the frame's sprites.
+     * not thread-safe: spawn from the update function (or anywhere on the thread that runs it), not from
+     * parallel entity updates.
+     */
+    class ParticleSystem {
+        public:
+            /*
+             * at most `capacity` live particles across all emitters; spawns beyond that are dropped.
+             */
+            explicit ParticleSystem(size_t capacity = 1 << 17);
+
+            /*
+             * add an emitter and return its id. ids are indices, handed out from 0 and never reused.
+             */
+            size_t addEmitter(const ParticleEmitter& emitter);
+
+            /*
+             * change an emitter. takes effect for new particles at once, and for the look and motion of live ones.
+             */
+            ParticleEmitter& getEmitter(size_t emitter) {return pools[emitter].emitter;}
+            size_t getEmitterCount() const {return pools.size();}
+
+            /*
+             * spawn `count` particles at (x, y). returns how many fit under the capacity.
+             */
+            size_t burst(size_t emitter, float x, float y, size_t count);
+
+            /*
+             * continuous emission at the emitter's rate, from (x, y). off by default.
+             */
+            void setEmitting(size_t emitter, bool emitting);
+            void setEmitterPosition(size_t emitter, float x, float y);
+
+            /*
+             * age, move and retire particles, and run continuous emission, over dt seconds.
+             */
+            void update(float dt);
+
+            /*
+             * build the quads of every particle that overlaps `view` (game coordinates) into `out`, which is begun first.
+             */
+            void record(const SDL_FRect& view, ParticleBatch& out) const;
+
+            /*
+             * kill every particle. emitters stay.
+             */
+            void clear();
+
+            /*
+             * live particles, overall and for one emitter.
+             */
+            size_t size() const {return live;}
+            size_t size(size_t emitter) const {return pools[emitter].x.size();}
+            size_t getCapacity() const {return capacity;}
+
+        private:
+            struct Pool {
+                ParticleEmitter emitter;
+                float emitX = 0, emitY = 0;
+                bool emitting = false;
+                float pending = 0;
+
+                std::vector<float> x, y, vx, vy, age, invLife;
+            };
+
+            size_t spawn(Pool& pool, float x, float y, size_t count);
+            float random();
+
+            std::vector<Pool> pools;
+            size_t capacity;
+            size_t live = 0;
+            uint32_t seed = 0x9e3779b9u;
+    };
+}
@@ -1,13 +1,29 @@
 #include "physics.h"
+#include "world.h"
+#include "integrator.h"
+#include <atomic>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 
 namespace Engine {
 
+    void Physics::setGravity(float g) {
+        defaultWorld().setGravity(g);
+    }
+
+    float Physics::getGravity() {
+        return defaultWorld().getGravity();
+    }
+
     void Physics::apply(Entity * e, float dt) {
+        apply(*e->getWorld(), e, dt);
+    }
+
+    void Physics::apply(World& world, Entity * e, float dt) {
 
         if (e->hasGravity()) {
-            e->applyForce(0, gravity * dt);
+            e->applyForce(0, world.getGravity() * dt);
         }
 
 
@@ -36,4 +52,80 @@ namespace Engine {
 
         e->translate(v_x * dt, v_y * dt);
     }
+
+    /*
+     * constant-initialized, so it's AUTO before any static constructor runs; AUTO is resolved on first use.
+     * atomic because the first use may be several physics jobs at once.
+     */
+    static std::atomic<Physics::Integrator> sIntegrator{Physics::AUTO};
+
+    bool Physics::supports(Integrator integrator) {
+        switch (integrator) {
+            case SCALAR: return true;
+            case SSE2: return Integrate::hasSSE2();
+            case AVX2: return Integrate::hasAVX2();
+            default: return true;
+        }
+    }
+
+    /*
+     * the integrator that actually runs for a requested one: the widest supported one at or below it.
+     */
+    static Physics::Integrator resolve(Physics::Integrator integrator) {
+        if (integrator == Physics::AUTO) integrator = Physics::AVX2;
+        while (integrator > Physics::SCALAR && !Physics::supports(integrator)) {
+            integrator = (Physics::Integrator)(integrator - 1);
+        }
+        return integrator;
+    }
+
+    Physics::Integrator Physics::setIntegrator(Integrator integrator) {
+        integrator = resolve(integrator);
+        sIntegrator.store(integrator, std::memory_order_relaxed);
+        return integrator;
+    }
+
+    Physics::Integrator Physics::getIntegrator() {
+        Integrator integrator = sIntegrator.load(std::memory_order_relaxed);
+        if (integrator == AUTO) {
+            // racing first uses all store the same answer.
+            integrator = resolve(AUTO);
+            sIntegrator.store(integrator, std::memory_order_relaxed);
+        }
+        return integrator;
+    }
+
+    const char* Physics::name(Integrator integrator) {
+        switch (integrator) {
+            case SCALAR: return "scalar";
+            case SSE2: return "sse2";
+            case AVX2: return "avx2";
+            default: return "auto";
+        }
+    }
+
+    Physics::Integrator Physics::fromName(const char* name) {
+        for (Integrator i : {SCALAR, SSE2, AVX2}) {
+            if (std::strcmp(name, Physics::name(i)) == 0) return i;
+        }
+        return AUTO;
+    }
+
+    void Physics::step(World& world, float dt) {
+        step(world, dt, 0, world.getPhysicsCount());
+    }
+
+    void Physics::step(World& world, float dt, size_t begin, size_t end) {
+        // outside a fixed step, movement drags the interpolation start point along (see Entity::translate).
+        Integrate::Params params = {dt, world.getGravity() * dt, !world.inFixedStep()};
+        Kinematics& k = world.getKinematics();
+        end = std::min(end, world.getPhysicsCount());
+        world.markPhysicsMoved();
+
+        switch (getIntegrator()) {
+            case AVX2: Integrate::avx2(k, begin, end, params); break;
+            case SSE2: Integrate::sse2(k, begin, end, params); break;
+            default: Integrate::scalar(k, begin, end, params); break;
+        }
+    }
 }
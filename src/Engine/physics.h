@@ -5,13 +5,10 @@
 #include <algorithm>
 
 namespace Engine {
+    class World;
+
     class Physics {
         private:
-            /*
-             * strength of gravity in pixels/sec^2.
-             */
-            static inline float gravity = 2000;
-
             /*
              * utility function for clamping a signed value while preserving the sign
              * (useful for friction and max speed calculations.)
@@ -23,18 +20,67 @@ namespace Engine {
         public:
 
             /*
-             * apply physics to an entity given the time step. called automatically by Engine::main().
+             * kernels Physics::step can use to integrate a world's bodies. all of them give identical results.
+             *     AUTO   - the widest one the cpu supports (default)
+             *     SCALAR - one body at a time
+             *     SSE2   - 4 bodies at a time
+             *     AVX2   - 8 bodies at a time
+             */
+            enum Integrator {AUTO = 0, SCALAR, SSE2, AVX2};
+
+            /*
+             * apply physics to an entity given the time step, using the gravity of the given world.
+             */
+            static void apply(World& world, Entity* e, float dt);
+
+            /*
+             * apply physics to an entity using the gravity of the world it belongs to.
              */
             static void apply(Entity* e, float dt);
 
             /*
-             * set the global strength of gravity.
+             * apply physics to every physics-enabled entity in a world, streaming through its
+             * Kinematics arrays. same result as calling apply() on each of them; called when a world is stepped.
+             */
+            static void step(World& world, float dt);
+
+            /*
+             * apply physics to rows [begin, end) of the world's physics range only. chunks that don't
+             * overlap can be stepped from different threads at the same time.
+             */
+            static void step(World& world, float dt, size_t begin, size_t end);
+
+            /*
+             * choose the integrator used by step(), for every world. an integrator the cpu can't run
+             * falls back to the next narrower one. returns the integrator that will actually be used.
+             */
+            static Integrator setIntegrator(Integrator integrator);
+
+            /*
+             * the integrator step() is using (never AUTO).
+             */
+            static Integrator getIntegrator();
+
+            /*
+             * whether the cpu can run the given integrator.
+             */
+            static bool supports(Integrator integrator);
+
+            /*
+             * lowercase name of an integrator ("auto", "scalar", "sse2", "avx2"), and the reverse.
+             * fromName returns AUTO for unknown names.
+             */
+            static const char* name(Integrator integrator);
+            static Integrator fromName(const char* name);
+
+            /*
+             * set the strength of gravity in the default world (see World::setGravity for other worlds).
              */
-            static void setGravity(float g) {gravity = g;}
+            static void setGravity(float g);
 
             /*
-             * get the current strength of gravity
+             * get the current strength of gravity in the default world.
              */
-            static float getGravity() {return gravity;}
+            static float getGravity();
     };
 }
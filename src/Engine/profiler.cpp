@@ -0,0 +1,251 @@
+#include "profiler.h"
+#include "core.h"
+#include "text.h"
+#include "trace.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace Engine::Profiler {
+
+    static std::atomic<bool> sEnabled{false};
+    static std::thread::id sOwner;
+    static std::thread::id sHelper;
+
+    /*
+     * per-phase ring buffers of frame times in ms, plus the frame being recorded.
+     */
+    static size_t sHistory = 240;
+    static std::vector<float> sSamples[PHASE_COUNT];
+    static size_t sHead = 0;
+    static size_t sCount = 0;
+    static double sCurrent[PHASE_COUNT] = {};
+    static double sHelperCurrent[PHASE_COUNT] = {};
+    static std::chrono::steady_clock::time_point sFrameStart;
+
+    /*
+     * the overlay's text: the font it uses (the built-in one unless setOverlayFont was called) and the batch
+     * its lines are queued into, drawn with one call at the end.
+     */
+    static Font sDefaultFont;
+    static Font* sFont = nullptr;
+    static SpriteBatch sText;
+
+    static const char* PHASE_NAMES[PHASE_COUNT] = {
+        "events", "input", "upload", "physics", "update", "contacts", "user", "particles", "clear", "draw", "indicators", "overlay", "present", "frame"
+    };
+
+    static void clear() {
+        for (auto& samples : sSamples) samples.assign(sHistory, 0.0f);
+        std::fill(std::begin(sCurrent), std::end(sCurrent), 0.0);
+        std::fill(std::begin(sHelperCurrent), std::end(sHelperCurrent), 0.0);
+        sHead = 0;
+        sCount = 0;
+    }
+
+    static bool recordingHere() {
+        return sEnabled.load(std::memory_order_relaxed) && std::this_thread::get_id() == sOwner;
+    }
+
+    /*
+     * the buffer the calling thread's timers add into, or null if it doesn't record.
+     */
+    static double* currentHere() {
+        if (!sEnabled.load(std::memory_order_relaxed)) return nullptr;
+        std::thread::id self = std::this_thread::get_id();
+        if (self == sOwner) return sCurrent;
+        if (self == sHelper) return sHelperCurrent;
+        return nullptr;
+    }
+
+    void setEnabled(bool enabled) {
+        if (enabled) {
+            sOwner = std::this_thread::get_id();
+            clear();
+            sFrameStart = std::chrono::steady_clock::now();
+        }
+        sEnabled.store(enabled);
+    }
+
+    bool isEnabled() {return sEnabled.load();}
+
+    void setHistory(size_t frames) {
+        sHistory = std::max<size_t>(1, frames);
+        clear();
+    }
+
+    void beginFrame() {
+        if (!recordingHere()) return;
+        sFrameStart = std::chrono::steady_clock::now();
+    }
+
+    void endFrame() {
+        if (!recordingHere()) return;
+
+        sCurrent[FRAME] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sFrameStart).count();
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            sSamples[p][sHead] = (float)sCurrent[p];
+            sCurrent[p] = 0.0;
+        }
+        sHead = (sHead + 1) % sHistory;
+        sCount = std::min(sCount + 1, sHistory);
+    }
+
+    void setHelperThread(std::thread::id thread) {
+        sHelper = thread;
+        std::fill(std::begin(sHelperCurrent), std::end(sHelperCurrent), 0.0);
+    }
+
+    void mergeHelper() {
+        if (!recordingHere()) return;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            sCurrent[p] += sHelperCurrent[p];
+            sHelperCurrent[p] = 0.0;
+        }
+    }
+
+    void add(Phase phase, double ms) {
+        if (double* current = currentHere()) current[phase] += ms;
+    }
+
+    Scope::Scope(Phase phase) : phase(phase), into(currentHere()), tracing(Trace::isEnabled()) {
+        if (into || tracing) start = std::chrono::steady_clock::now();
+    }
+
+    Scope::~Scope() {
+        if (!into && !tracing) return;
+
+        auto end = std::chrono::steady_clock::now();
+        if (into) into[phase] += std::chrono::duration<double, std::milli>(end - start).count();
+        if (tracing) Trace::complete(PHASE_NAMES[phase], start, end);
+    }
+
+    Stats getStats(Phase phase) {
+        Stats stats;
+        if (sCount == 0) return stats;
+
+        // the ring is only full once sCount == sHistory; before that the samples are [0, sCount).
+        std::vector<float> sorted(sSamples[phase].begin(), sSamples[phase].begin() + sCount);
+        stats.last = sSamples[phase][(sHead + sHistory - 1) % sHistory];
+        stats.frames = sCount;
+
+        double sum = 0;
+        for (float v : sorted) sum += v;
+        stats.avg = sum / sCount;
+
+        std::sort(sorted.begin(), sorted.end());
+        stats.p50 = sorted[(sCount - 1) / 2];
+        stats.p99 = sorted[(size_t)((sCount - 1) * 0.99)];
+        stats.max = sorted.back();
+        return stats;
+    }
+
+    const char* name(Phase phase) {
+        return phase >= 0 && phase < PHASE_COUNT ? PHASE_NAMES[phase] : "unknown";
+    }
+
+    void setOverlayFont(Font* font) {sFont = font;}
+
+    void drawOverlay() {
+        if (!renderer) return;
+
+        Font& font = sFont ? *sFont : sDefaultFont;
+        const char* HEADER = "phase        p50    p99    max ms";
+        const SDL_FColor WHITE{1.0f, 1.0f, 1.0f, 1.0f};
+        const float LINE = std::max(12.0f, font.getLineHeight() + 2.0f);
+        const float BAR_W = 160.0f;
+        const float TEXT_W = font.measure(HEADER).x;
+        const double SCALE_MS = 1000.0 / 60.0;
+
+        int w = 0, h = 0;
+        SDL_GetCurrentRenderOutputSize(renderer, &w, &h);
+        float panelW = TEXT_W + BAR_W + 16.0f;
+        float x = (float)w - panelW - 8.0f;
+        float y = 8.0f;
+
+        Uint8 r, g, b, a;
+        SDL_BlendMode blend;
+        SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+        SDL_GetRenderDrawBlendMode(renderer, &blend);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+        SDL_FRect panel{x, y, panelW, LINE * (PHASE_COUNT + 3) + 8.0f};
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+        SDL_RenderFillRect(renderer, &panel);
+
+        sText.begin();
+        font.draw(sText, HEADER, x + 4, y + 4, WHITE);
+
+        char line[64];
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            Stats s = getStats((Phase)p);
+            float rowY = y + 4 + LINE * (p + 1);
+
+            std::snprintf(line, sizeof(line), "%-10s %6.2f %6.2f %6.2f", PHASE_NAMES[p], s.p50, s.p99, s.max);
+            font.draw(sText, line, x + 4, rowY, WHITE);
+
+            // p50 filled, p99 outlined; red once the phase alone blows a 60 Hz frame.
+            float barX = x + 8 + TEXT_W;
+            SDL_FRect p50{barX, rowY, (float)std::min(1.0, s.p50 / SCALE_MS) * BAR_W, LINE - 4};
+            SDL_FRect p99{barX, rowY, (float)std::min(1.0, s.p99 / SCALE_MS) * BAR_W, LINE - 4};
+            if (s.p99 > SCALE_MS) SDL_SetRenderDrawColor(renderer, 220, 20, 60, 255);
+            else SDL_SetRenderDrawColor(renderer, 0, 200, 70, 255);
+            SDL_RenderFillRect(renderer, &p50);
+            SDL_RenderRect(renderer, &p99);
+        }
+
+        SpriteBatch& batch = getSpriteBatch();
+        StaticLayerCache& statics = getStaticLayers();
+        std::snprintf(line, sizeof(line), "sprites %zu  culled %zu  calls %zu  chunks %zu (%zu redrawn)",
+                      batch.getSpriteCount(), getCulledCount(), batch.getDrawCalls(),
+                      statics.getTextureCount(), statics.getRedrawCount());
+        font.draw(sText, line, x + 4, y + 4 + LINE * (PHASE_COUNT + 1), WHITE);
+
+        ParticleBatch& particles = getParticleBatch();
+        std::snprintf(line, sizeof(line), "particles %zu live, %zu drawn  calls %zu",
+                      particles.getLiveCount(), particles.getParticleCount(), particles.getDrawCalls());
+        font.draw(sText, line, x + 4, y + 4 + LINE * (PHASE_COUNT + 2), WHITE);
+
+        // the overlay is drawn in window pixels, after the frame has been scaled.
+        sText.flush(renderer, Scaling::Transform{});
+
+        SDL_SetRenderDrawBlendMode(renderer, blend);
+        SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    }
+
+    bool writeCSV(const std::string& filename, const std::string& label) {
+        FILE* f = std::fopen(filename.c_str(), std::filesystem::exists(filename) ? "a" : "w");
+        if (!f) return false;
+
+        if (std::ftell(f) == 0) {
+            std::fprintf(f, "label,phase,frames,avg_ms,p50_ms,p99_ms,max_ms\n");
+        }
+
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            Stats s = getStats((Phase)p);
+            std::fprintf(f, "%s,%s,%zu,%.3f,%.3f,%.3f,%.3f\n",
+                         label.c_str(), PHASE_NAMES[p], s.frames, s.avg, s.p50, s.p99, s.max);
+        }
+        std::fclose(f);
+        return true;
+    }
+
+    bool writeJSON(const std::string& filename, const std::string& label) {
+        FILE* f = std::fopen(filename.c_str(), "w");
+        if (!f) return false;
+
+        std::fprintf(f, "{\n  \"label\": \"%s\",\n  \"frames\": %zu,\n  \"phases\": [\n", label.c_str(), sCount);
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            Stats s = getStats((Phase)p);
+            std::fprintf(f, "    {\"phase\": \"%s\", \"avg_ms\": %.3f, \"p50_ms\": %.3f, \"p99_ms\": %.3f, \"max_ms\": %.3f}%s\n",
+                         PHASE_NAMES[p], s.avg, s.p50, s.p99, s.max, p + 1 < PHASE_COUNT ? "," : "");
+        }
+        std::fprintf(f, "  ]\n}\n");
+        std::fclose(f);
+        return true;
+    }
+}
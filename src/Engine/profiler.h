@@ -0,0 +1,137 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+/*
+ * per-phase frame profiler.
+ *
+ * Engine::main() times each phase of a frame with scoped timers and keeps the last few hundred
+ * frames in a ring buffer, so you can see where a frame's time goes (p50/p99/max per phase).
+ * only the thread that enabled the profiler records, plus a helper thread running part of its frame
+ * (see setHelperThread); timers on other threads (e.g. worlds stepped on their own thread, or job
+ * system workers) are ignored.
+ */
+namespace Engine {
+    class Font;
+}
+
+namespace Engine::Profiler {
+
+    /*
+     * the timed phases of an Engine::main() frame, in the order they run.
+     *     EVENTS     - SDL event polling
+     *     INPUT      - timeline tick and Input::update
+     *     UPLOAD     - turning asynchronously loaded images into textures (see Textures::pump)
+     *     PHYSICS    - physics for worlds stepped on the recording or helper thread (all fixed steps this frame)
+     *     UPDATE     - Entity::update for those worlds, including deferred calls
+     *     CONTACTS   - finding their contacts and raising enter/exit events (see World::setContactEvents)
+     *     USER       - the update function passed to Engine::main()
+     *     PARTICLES  - updating Engine::getParticles()
+     *     CLEAR      - clearing the screen
+     *     DRAW       - drawing entities
+     *     INDICATORS - recording/playback indicators
+     *     OVERLAY    - the overlay renderer (see Engine::setOverlayRenderer)
+     *     PRESENT    - SDL_RenderPresent, including the vsync wait
+     *     FRAME      - the whole frame
+     */
+    enum Phase {EVENTS = 0, INPUT, UPLOAD, PHYSICS, UPDATE, CONTACTS, USER, PARTICLES, CLEAR, DRAW, INDICATORS, OVERLAY, PRESENT, FRAME, PHASE_COUNT};
+
+    /*
+     * summary of one phase over the frames in the ring buffer, in milliseconds.
+     */
+    struct Stats {
+        double last = 0;
+        double avg = 0;
+        double p50 = 0;
+        double p99 = 0;
+        double max = 0;
+        size_t frames = 0;
+    };
+
+    /*
+     * start/stop recording on the calling thread. enabling clears the history.
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled();
+
+    /*
+     * number of frames kept per phase. defaults to 240. clears the history.
+     */
+    void setHistory(size_t frames);
+
+    /*
+     * frame boundaries. called by Engine::main(); call them yourself when driving the engine with step().
+     */
+    void beginFrame();
+    void endFrame();
+
+    /*
+     * let another thread record phases of the recording thread's frames, e.g. the simulation thread
+     * under Engine::setPipelinedRendering. it records into a buffer of its own, which mergeHelper()
+     * adds into the current frame; call that on the recording thread once the helper's work for the
+     * frame is done (after waiting on it, so the two don't overlap). a default id removes the helper.
+     */
+    void setHelperThread(std::thread::id thread);
+    void mergeHelper();
+
+    /*
+     * add time to a phase of the current frame. a phase timed more than once per frame adds up.
+     */
+    void add(Phase phase, double ms);
+
+    /*
+     * times its enclosing scope into a phase. also shows up as a span in Engine::Trace while tracing.
+     */
+    class Scope {
+        public:
+            explicit Scope(Phase phase);
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            Phase phase;
+            double* into;
+            bool tracing;
+            std::chrono::steady_clock::time_point start;
+    };
+
+    /*
+     * stats for a phase over the recorded frames.
+     */
+    Stats getStats(Phase phase);
+
+    /*
+     * lowercase name of a phase, as used in the overlay and the CSV/JSON output.
+     */
+    const char* name(Phase phase);
+
+    /*
+     * draw a bar per phase (p50 solid, p99 outlined, against a 1/60s scale) with its numbers,
+     * and the last frame's sprite, culled, draw call and particle counts.
+     * matches the OverlayRenderer signature, so it can be passed straight to Engine::setOverlayRenderer.
+     * its text is drawn from a glyph atlas (see Font) in one batch, so redrawing it every frame is cheap.
+     */
+    void drawOverlay();
+
+    /*
+     * the font drawOverlay() uses; null (the default) for SDL's built-in 8x8 font. the font isn't owned
+     * and has to outlive its use. a monospaced font keeps the columns lined up.
+     */
+    void setOverlayFont(Font* font);
+
+    /*
+     * append one row per phase to a CSV file, writing the header if the file is new:
+     *     label,phase,frames,avg_ms,p50_ms,p99_ms,max_ms
+     * returns false if the file can't be opened.
+     */
+    bool writeCSV(const std::string& filename, const std::string& label);
+
+    /*
+     * write the same data as a JSON object to a file (overwriting it).
+     */
+    bool writeJSON(const std::string& filename, const std::string& label);
+}
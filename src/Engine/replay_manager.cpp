@@ -1,6 +1,7 @@
 #include "replay_manager.h"
 #include "events.h"
 #include "replay_events.h"
+#include "trace.h"
 #include <algorithm>
 #include <iostream>
 
@@ -148,6 +149,7 @@ namespace Engine {
 
     void ReplayManager::update() {
         if (!playing_ || paused_) return;
+        TRACE_SCOPE("ReplayManager::update");
         
         double currentPlaybackTime = timeline_->now() - playbackStartTime_;
         playbackTime_ = currentPlaybackTime;
@@ -3,11 +3,12 @@
 #include <SDL3/SDL_log.h>
 #include <SDL3/SDL_rect.h>
 #include <SDL3/SDL_video.h>
+#include <algorithm>
 
 namespace Engine {
-    SDL_FRect Scaling::apply(SDL_FRect rect) {
-        int current_w;
-        int current_h;
+    Scaling::Transform Scaling::getTransform() {
+        int current_w = WINDOW_WIDTH;
+        int current_h = WINDOW_HEIGHT;
 
         if (!SDL_GetWindowSize(window, &current_w, &current_h))
             SDL_Log("Can't get window size: %s", SDL_GetError());
@@ -20,35 +21,24 @@ namespace Engine {
 
         switch (scalingMode) {
             case PROPORTIONAL:
-                return {
-                    rect.x * x_scaling,
-                    rect.y * y_scaling,
-                    rect.w * x_scaling,
-                    rect.h * y_scaling
-                };
+                return {x_scaling, y_scaling, 0, 0};
             case PROPORTIONAL_MAINTAIN_ASPECT_X:
-
-
-
-                return {
-                    rect.x * y_scaling + x_shift,
-                    rect.y * y_scaling,
-                    rect.w * y_scaling,
-                    rect.h * y_scaling
-                };
+                return {y_scaling, y_scaling, x_shift, 0};
             case PROPORTIONAL_MAINTAIN_ASPECT_Y:
-            return {
-                rect.x * x_scaling,
-                rect.y * x_scaling + y_shift,
-                rect.w * x_scaling,
-                rect.h * x_scaling
-            };
+                return {x_scaling, x_scaling, 0, y_shift};
+            case INTERNAL_RESOLUTION:
+                // game coordinates are target pixels; the scaling happens once, in getPresentRect.
+                return {};
             default:
                 scalingMode = FIXED;
-                return rect;
+                return {};
         }
     }
 
+    SDL_FRect Scaling::apply(SDL_FRect rect) {
+        return getTransform().apply(rect);
+    }
+
     SDL_FRect Scaling::getVisibleArea() {
         int current_w;
         int current_h;
@@ -69,8 +59,23 @@ namespace Engine {
                 return {(WINDOW_WIDTH - width_scaling) / 2, 0, width_scaling, WINDOW_HEIGHT};
             case PROPORTIONAL_MAINTAIN_ASPECT_Y:
                 return {0, (WINDOW_HEIGHT - height_scaling) / 2, WINDOW_WIDTH, height_scaling};
+            case INTERNAL_RESOLUTION:
+                return {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
             default:
                 return {0, 0, (float)current_w, (float)current_h};
         }
     }
+
+    SDL_FRect Scaling::getPresentRect() {
+        int current_w = WINDOW_WIDTH;
+        int current_h = WINDOW_HEIGHT;
+
+        if (!SDL_GetWindowSize(window, &current_w, &current_h))
+            SDL_Log("Can't get window size: %s", SDL_GetError());
+
+        float scale = std::min((float)current_w / (float)WINDOW_WIDTH, (float)current_h / (float)WINDOW_HEIGHT);
+        float w = WINDOW_WIDTH * scale;
+        float h = WINDOW_HEIGHT * scale;
+        return {((float)current_w - w) / 2, ((float)current_h - h) / 2, w, h};
+    }
 }
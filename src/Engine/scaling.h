@@ -34,6 +34,15 @@ namespace Engine {
          */
          static const int PROPORTIONAL_MAINTAIN_ASPECT_Y = 3;
 
+        /*
+         * render the world at WINDOW_WIDTH x WINDOW_HEIGHT into an offscreen target, then scale that into the window
+         * once per frame, keeping its aspect ratio (with black bars where the window's differs; see getPresentRect).
+         * sprites need no per-rect scaling and draw cost doesn't depend on the window size.
+         * the indicators and overlay are still drawn on top in window pixels.
+         * only Engine::main() draws this way; Entity::draw() draws unscaled into whatever target is current.
+         */
+        static const int INTERNAL_RESOLUTION = 4;
+
          /*
           * set the window scaling mode.
           * valid options:
@@ -41,6 +50,7 @@ namespace Engine {
           *     PROPORTIONAL
           *     PROPORTIONAL_MAINTAIN_ASPECT_X
           *     PROPORTIONAL_MAINTAIN_ASPECT_Y
+          *     INTERNAL_RESOLUTION
           *
           * invalid values will behave like FIXED.
           */
@@ -51,9 +61,27 @@ namespace Engine {
           */
          static int getMode() {return scalingMode;}
 
+         /*
+          * the current scaling mode as a scale and offset: x' = x * sx + tx, w' = w * sx (same for y/h).
+          */
+         struct Transform {
+             float sx = 1, sy = 1;
+             float tx = 0, ty = 0;
+
+             SDL_FRect apply(SDL_FRect rect) const {
+                 return {rect.x * sx + tx, rect.y * sy + ty, rect.w * sx, rect.h * sy};
+             }
+         };
+
+         /*
+          * compute the transform for the current window size and scaling mode.
+          * queries the window size, so compute it once per frame and reuse it rather than calling apply() per rect.
+          */
+         static Transform getTransform();
+
          /*
           * apply the current scaling mode to the given rect.
-          * called internally by Entity draw method.
+          * same as getTransform().apply(rect).
           */
          static SDL_FRect apply(SDL_FRect rect);
 
@@ -65,5 +93,11 @@ namespace Engine {
           * center content, so x and y may be negative.
           */
          static SDL_FRect getVisibleArea();
+
+         /*
+          * where the INTERNAL_RESOLUTION image goes in the window, in window pixels:
+          * as large as fits with its aspect ratio kept, centered.
+          */
+         static SDL_FRect getPresentRect();
     };
 }
@@ -1,6 +1,8 @@
 #include "Engine/server.h"
+#include "Engine/trace.h"
 #include <zmq.h>
 #include <unordered_map>
+#include <vector>
 #include <thread>
 #include <atomic>
 #include <chrono>
@@ -33,11 +35,13 @@ void cmdLoop(std::atomic<bool>* running, const char* host, int cmdPort, void* ct
     void* rep = zmq_socket(ctx, ZMQ_REP); if (!rep) { std::cerr << "[Server] REP socket failed\n"; return; }
     set_linger0(rep);
     if (!bind_tcp(rep, host, cmdPort)) { std::cerr << "[Server] bind REP failed\n"; zmq_close(rep); return; }
+    TRACE_THREAD("server cmd");
     int nextId = 1;
     while (running->load()) {
         uint8_t buf[512];
         int n = zmq_recv(rep, buf, sizeof(buf), 0);
         if (n <= 0) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); continue; }
+        TRACE_SCOPE("cmd request");
         MsgKind kind = *(MsgKind*)buf;
         if (kind == MsgKind::Hello) {
             HelloAck ack{}; ack.assigned_id = nextId++; ack.cmd_port = cmdPort; ack.pub_port = 0;
@@ -61,11 +65,13 @@ void dirLoop(std::atomic<bool>* running, const char* host, int dirPort, void* ct
 
     std::unordered_map<int32_t, PeerInfo> peers;
     int32_t nextId = 1;
+    TRACE_THREAD("server dir");
 
     while (running->load()) {
         uint8_t buf[1024];
         int n = zmq_recv(rep, buf, sizeof(buf), 0);
         if (n < (int)sizeof(P2DRegister)) { zmq_send(rep,"",0,0); continue; }
+        TRACE_SCOPE("dir request");
         auto* reg = (P2DRegister*)buf;
 
         int32_t id = reg->player_id;
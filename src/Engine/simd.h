@@ -0,0 +1,24 @@
+#pragma once
+
+/*
+ * shared setup for the engine's hand-written x86 SIMD kernels (integrator.cpp, particles.cpp).
+ *
+ * ENGINE_X86 is 1 when the intrinsics are available. ENGINE_TARGET_SSE2 / ENGINE_TARGET_AVX2 mark a function to be
+ * compiled for that instruction set whatever -march says; call such a function only after checking
+ * Integrate::hasSSE2() / hasAVX2() (Physics::getIntegrator() already has).
+ */
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define ENGINE_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define ENGINE_TARGET_SSE2
+        #define ENGINE_TARGET_AVX2
+    #else
+        // compile these kernels for the wider ISA regardless of -march; they only run after the cpu check.
+        #define ENGINE_TARGET_SSE2 __attribute__((target("sse2")))
+        #define ENGINE_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#else
+    #define ENGINE_X86 0
+#endif
@@ -0,0 +1,175 @@
+#include "spatial_hash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+
+    /*
+     * cell coordinates are clamped so far-away (or non-finite) boxes can't overflow an int.
+     */
+    static const float MAX_CELL = (float)(1 << 30);
+
+    SpatialHash::SpatialHash(float size) {
+        setCellSize(size);
+    }
+
+    void SpatialHash::setCellSize(float size) {
+        cellSize = size > 0 ? size : 256.0f;
+        invCellSize = 1.0f / cellSize;
+        clear();
+    }
+
+    void SpatialHash::clear() {
+        items.clear();
+        cells.clear();
+        oversized.clear();
+        stamps.clear();
+        count = 0;
+    }
+
+    int SpatialHash::cellOf(float v) const {
+        float c = std::floor(v * invCellSize);
+        if (!(c > -MAX_CELL)) return -(int)MAX_CELL;
+        if (c > MAX_CELL) return (int)MAX_CELL;
+        return (int)c;
+    }
+
+    void SpatialHash::link(uint32_t id) {
+        Item& item = items[id];
+        item.x0 = cellOf(item.box.x);
+        item.y0 = cellOf(item.box.y);
+        item.x1 = cellOf(item.box.x + item.box.w);
+        item.y1 = cellOf(item.box.y + item.box.h);
+
+        int64_t cellCount = (int64_t)(item.x1 - item.x0 + 1) * (item.y1 - item.y0 + 1);
+        item.oversized = cellCount > MAX_CELLS;
+        if (item.oversized) {
+            oversized.push_back(id);
+            return;
+        }
+
+        for (int cy = item.y0; cy <= item.y1; cy++) {
+            for (int cx = item.x0; cx <= item.x1; cx++) {
+                cells[key(cx, cy)].push_back(id);
+            }
+        }
+    }
+
+    void SpatialHash::unlink(uint32_t id) {
+        Item& item = items[id];
+        if (item.oversized) {
+            auto it = std::find(oversized.begin(), oversized.end(), id);
+            *it = oversized.back();
+            oversized.pop_back();
+            return;
+        }
+
+        for (int cy = item.y0; cy <= item.y1; cy++) {
+            for (int cx = item.x0; cx <= item.x1; cx++) {
+                auto cell = cells.find(key(cx, cy));
+                std::vector<uint32_t>& ids = cell->second;
+                auto it = std::find(ids.begin(), ids.end(), id);
+                *it = ids.back();
+                ids.pop_back();
+                // scrolling worlds keep visiting new cells; don't keep the old ones around.
+                if (ids.empty()) cells.erase(cell);
+            }
+        }
+    }
+
+    void SpatialHash::insert(uint32_t id, const SDL_FRect& box) {
+        if (id >= items.size()) {
+            items.resize(id + 1);
+            stamps.resize(id + 1, 0);
+        }
+
+        Item& item = items[id];
+        if (item.live) {
+            // most moves stay inside the same cells.
+            if (!item.oversized && cellOf(box.x) == item.x0 && cellOf(box.y) == item.y0 &&
+                cellOf(box.x + box.w) == item.x1 && cellOf(box.y + box.h) == item.y1) {
+                item.box = box;
+                return;
+            }
+            unlink(id);
+        } else {
+            item.live = true;
+            count++;
+        }
+
+        item.box = box;
+        link(id);
+    }
+
+    void SpatialHash::remove(uint32_t id) {
+        if (!contains(id)) return;
+        unlink(id);
+        items[id].live = false;
+        count--;
+    }
+
+    void SpatialHash::query(const SDL_FRect& area, std::vector<uint32_t>& out) {
+        if (count == 0) return;
+
+        if (++stamp == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            stamp = 1;
+        }
+
+        auto visit = [&](uint32_t id) {
+            if (stamps[id] == stamp) return;
+            stamps[id] = stamp;
+            if (overlaps(items[id].box, area)) out.push_back(id);
+        };
+
+        int x0 = cellOf(area.x), y0 = cellOf(area.y);
+        int x1 = cellOf(area.x + area.w), y1 = cellOf(area.y + area.h);
+        int64_t areaCells = (int64_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+
+        if (areaCells > (int64_t)cells.size()) {
+            // the query covers more cells than are occupied; walk the occupied ones instead.
+            for (auto& [k, ids] : cells) {
+                int cx = (int)(int32_t)(k >> 32), cy = (int)(int32_t)(uint32_t)k;
+                if (cx < x0 || cx > x1 || cy < y0 || cy > y1) continue;
+                for (uint32_t id : ids) visit(id);
+            }
+        } else {
+            for (int cy = y0; cy <= y1; cy++) {
+                for (int cx = x0; cx <= x1; cx++) {
+                    auto cell = cells.find(key(cx, cy));
+                    if (cell == cells.end()) continue;
+                    for (uint32_t id : cell->second) visit(id);
+                }
+            }
+        }
+
+        for (uint32_t id : oversized) visit(id);
+    }
+
+    void SpatialHash::pairs(std::vector<std::pair<uint32_t, uint32_t>>& out) {
+        for (auto& [k, ids] : cells) {
+            int cx = (int)(int32_t)(k >> 32), cy = (int)(int32_t)(uint32_t)k;
+            for (size_t i = 0; i < ids.size(); i++) {
+                const Item& a = items[ids[i]];
+                for (size_t j = i + 1; j < ids.size(); j++) {
+                    const Item& b = items[ids[j]];
+                    // two overlapping boxes share every cell from the larger of their first cells on;
+                    // only the first of those reports them.
+                    if (std::max(a.x0, b.x0) != cx || std::max(a.y0, b.y0) != cy) continue;
+                    if (!overlaps(a.box, b.box)) continue;
+                    out.emplace_back(std::min(ids[i], ids[j]), std::max(ids[i], ids[j]));
+                }
+            }
+        }
+
+        for (uint32_t o : oversized) {
+            scratch.clear();
+            query(items[o].box, scratch);
+            for (uint32_t id : scratch) {
+                // two oversized boxes are reported from the lower one's turn.
+                if (id == o || (items[id].oversized && id < o)) continue;
+                out.emplace_back(std::min(id, o), std::max(id, o));
+            }
+        }
+    }
+}
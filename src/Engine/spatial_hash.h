@@ -0,0 +1,89 @@
+#pragma once
+#include <SDL3/SDL_rect.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Engine {
+
+    /*
+     * uniform grid of axis-aligned boxes, keyed by small integer ids, for "what is near this rect" queries.
+     *
+     * each box is listed in every cell it overlaps, so moving a box within its cells is just a store,
+     * and a query only visits the cells under the query rect. boxes that would cover more than
+     * MAX_CELLS cells are kept in a separate list that every query checks, so a huge background
+     * doesn't flood the grid.
+     *
+     * ids index a flat array, so keep them dense (e.g. World handle slots).
+     * not thread-safe, including query(), which reuses internal scratch space.
+     */
+    class SpatialHash {
+        public:
+            static const int MAX_CELLS = 64;
+
+            explicit SpatialHash(float cellSize = 256.0f);
+
+            /*
+             * change the cell size. clears the grid.
+             */
+            void setCellSize(float size);
+            float getCellSize() const {return cellSize;}
+
+            /*
+             * insert a box, or move it if the id is already present.
+             */
+            void insert(uint32_t id, const SDL_FRect& box);
+
+            /*
+             * remove a box. removing an id that isn't present does nothing.
+             */
+            void remove(uint32_t id);
+
+            bool contains(uint32_t id) const {return id < items.size() && items[id].live;}
+            size_t size() const {return count;}
+            void clear();
+
+            /*
+             * append to `out` the id of every box that overlaps `area` (touching edges don't count), each once.
+             * ids come out in no particular order.
+             */
+            void query(const SDL_FRect& area, std::vector<uint32_t>& out);
+
+            /*
+             * append to `out` every pair of boxes that overlap each other, each once, as (lower id, higher id).
+             * a pair is reported from just one of the cells the two share, so this costs about as much as
+             * comparing the boxes in each cell with each other, not a query() per box.
+             */
+            void pairs(std::vector<std::pair<uint32_t, uint32_t>>& out);
+
+        private:
+            struct Item {
+                SDL_FRect box;
+                int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+                bool live = false;
+                bool oversized = false;
+            };
+
+            int cellOf(float v) const;
+            static uint64_t key(int cx, int cy) {return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;}
+            static bool overlaps(const SDL_FRect& a, const SDL_FRect& b) {
+                return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+            }
+
+            void link(uint32_t id);
+            void unlink(uint32_t id);
+
+            float cellSize;
+            float invCellSize;
+            std::vector<Item> items;
+            std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+            std::vector<uint32_t> oversized;
+            size_t count = 0;
+
+            std::vector<uint32_t> stamps;
+            uint32_t stamp = 0;
+            std::vector<uint32_t> scratch;
+    };
+}
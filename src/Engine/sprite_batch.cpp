@@ -0,0 +1,144 @@
+#include "sprite_batch.h"
+#include "trace.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <numeric>
+
+namespace Engine {
+
+    void SpriteBatch::begin() {
+        sprites.clear();
+        keys.clear();
+        textureIds.clear();
+    }
+
+    void SpriteBatch::draw(SDL_Texture* texture, const SDL_FRect* src, const SDL_FRect& dst, int layer) {
+        draw(texture, src, dst, layer, SDL_FColor{1.0f, 1.0f, 1.0f, 1.0f});
+        if (texture) sprites.back().textureMod = true;
+    }
+
+    void SpriteBatch::draw(SDL_Texture* texture, const SDL_FRect* src, const SDL_FRect& dst, int layer, SDL_FColor color) {
+        if (!texture) return;
+
+        Sprite s;
+        s.texture = texture;
+        s.dst = dst;
+        s.color = color;
+        s.textureMod = false;
+        s.u0 = 0.0f; s.v0 = 0.0f;
+        s.u1 = 1.0f; s.v1 = 1.0f;
+        // texture->w/h are plain fields, unlike SDL_GetTextureSize, so this is safe off the render thread.
+        if (src && texture->w > 0 && texture->h > 0) {
+            s.u0 = src->x / texture->w;
+            s.v0 = src->y / texture->h;
+            s.u1 = (src->x + src->w) / texture->w;
+            s.v1 = (src->y + src->h) / texture->h;
+        }
+
+        // texture ids are handed out in first-seen order, so the sort is deterministic within a frame.
+        // past 65536 textures in one frame the ids wrap; that only costs extra draw calls.
+        auto id = textureIds.emplace(texture, (uint16_t)textureIds.size()).first->second;
+        int clamped = std::clamp(layer, -32768, 32767);
+        keys.resize(sprites.size() + 1);
+        keys.back() = ((uint32_t)(clamped + 32768) << 16) | id;
+        sprites.push_back(s);
+    }
+
+    void SpriteBatch::sort() {
+        size_t n = sprites.size();
+        order.resize(n);
+        scratch.resize(n);
+        std::iota(order.begin(), order.end(), 0u);
+
+        // LSD radix sort on the 32-bit key, 8 bits per pass. each pass is stable, so the result
+        // keeps queue order for equal keys. passes where every key has the same byte are skipped,
+        // which is the common case for the layer's high byte.
+        for (int shift = 0; shift < 32; shift += 8) {
+            size_t counts[256] = {};
+            for (size_t i = 0; i < n; i++) counts[(keys[i] >> shift) & 0xff]++;
+            if (counts[(keys[0] >> shift) & 0xff] == n) continue;
+
+            size_t offset = 0;
+            for (size_t& c : counts) {
+                size_t count = c;
+                c = offset;
+                offset += count;
+            }
+            for (size_t i = 0; i < n; i++) {
+                uint32_t idx = order[i];
+                scratch[counts[(keys[idx] >> shift) & 0xff]++] = idx;
+            }
+            order.swap(scratch);
+        }
+    }
+
+    void SpriteBatch::flush(SDL_Renderer* renderer, const Scaling::Transform& transform) {
+        lastSprites = sprites.size();
+        lastDrawCalls = 0;
+        if (sprites.empty() || !renderer) {
+            sprites.clear();
+            keys.clear();
+            return;
+        }
+
+        TRACE_SCOPE("sprite batch flush");
+        sort();
+
+        size_t n = sprites.size();
+        vertices.resize(n * 4);
+        SDL_Texture* modTexture = nullptr;
+        SDL_FColor mod{1.0f, 1.0f, 1.0f, 1.0f};
+        for (size_t i = 0; i < n; i++) {
+            const Sprite& s = sprites[order[i]];
+            SDL_FColor color = s.color;
+            if (s.textureMod) {
+                // sorted by texture, so this is one lookup per run.
+                if (s.texture != modTexture) {
+                    modTexture = s.texture;
+                    SDL_GetTextureColorModFloat(modTexture, &mod.r, &mod.g, &mod.b);
+                    SDL_GetTextureAlphaModFloat(modTexture, &mod.a);
+                }
+                color = mod;
+            }
+
+            SDL_FRect dst = transform.apply(s.dst);
+            float x0 = dst.x, y0 = dst.y;
+            float x1 = dst.x + dst.w, y1 = dst.y + dst.h;
+            SDL_Vertex* v = &vertices[i * 4];
+            v[0] = {{x0, y0}, color, {s.u0, s.v0}};
+            v[1] = {{x1, y0}, color, {s.u1, s.v0}};
+            v[2] = {{x1, y1}, color, {s.u1, s.v1}};
+            v[3] = {{x0, y1}, color, {s.u0, s.v1}};
+        }
+
+        // indices are relative to the start of a run, so one list serves every run.
+        size_t built = indices.size() / 6;
+        if (built < n) {
+            indices.resize(n * 6);
+            for (size_t i = built; i < n; i++) {
+                int base = (int)(i * 4);
+                int* q = &indices[i * 6];
+                q[0] = base; q[1] = base + 1; q[2] = base + 2;
+                q[3] = base + 2; q[4] = base + 3; q[5] = base;
+            }
+        }
+
+        size_t runStart = 0;
+        while (runStart < n) {
+            SDL_Texture* texture = sprites[order[runStart]].texture;
+            size_t runEnd = runStart + 1;
+            while (runEnd < n && sprites[order[runEnd]].texture == texture) runEnd++;
+
+            size_t count = runEnd - runStart;
+            if (!SDL_RenderGeometry(renderer, texture, &vertices[runStart * 4], (int)(count * 4),
+                                    indices.data(), (int)(count * 6))) {
+                SDL_Log("Can't draw sprite batch: %s", SDL_GetError());
+            }
+            lastDrawCalls++;
+            runStart = runEnd;
+        }
+
+        sprites.clear();
+        keys.clear();
+    }
+}
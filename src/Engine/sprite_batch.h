@@ -0,0 +1,82 @@
+#pragma once
+#include "scaling.h"
+#include <SDL3/SDL_pixels.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+
+    /*
+     * collects a frame's textured quads and submits them with as few SDL_RenderGeometry calls as possible.
+     *
+     * quads are sorted by layer, then by texture (a stable radix sort, so quads that share a layer and texture
+     * keep the order they were queued in), and each run of the same texture becomes one draw call.
+     * lower layers are drawn first. within a layer, quads with different textures may be reordered,
+     * so put things that have to overlap in a fixed order on different layers.
+     *
+     * queuing only touches the batch itself, so a batch can be filled on one thread and flushed on the thread
+     * that owns the renderer; that's how Engine::main() hands frames over when rendering is pipelined.
+     * Engine::main() draws every entity through one of these; see Entity::setLayer.
+     */
+    class SpriteBatch {
+        public:
+            /*
+             * drop everything queued since the last flush() and start a new frame of quads.
+             */
+            void begin();
+
+            /*
+             * queue a quad. src is in texture pixels (null for the whole texture), dst in game coordinates.
+             * the texture's color and alpha mod (as they are at flush time) are applied, like SDL_RenderTexture does.
+             */
+            void draw(SDL_Texture* texture, const SDL_FRect* src, const SDL_FRect& dst, int layer = 0);
+
+            /*
+             * queue a quad with an explicit tint instead of the texture's color and alpha mod.
+             */
+            void draw(SDL_Texture* texture, const SDL_FRect* src, const SDL_FRect& dst, int layer, SDL_FColor color);
+
+            /*
+             * sort and submit everything queued since begin(), then empty the batch.
+             * destination rects are mapped through `transform` (usually Scaling::getTransform(), computed once per frame).
+             */
+            void flush(SDL_Renderer* renderer, const Scaling::Transform& transform);
+
+            /*
+             * number of quads queued since begin().
+             */
+            size_t size() const {return sprites.size();}
+
+            /*
+             * quads and SDL_RenderGeometry calls submitted by the last flush().
+             */
+            size_t getSpriteCount() const {return lastSprites;}
+            size_t getDrawCalls() const {return lastDrawCalls;}
+
+        private:
+            struct Sprite {
+                SDL_Texture* texture;
+                SDL_FRect dst;
+                float u0, v0, u1, v1;
+                SDL_FColor color;
+                bool textureMod;
+            };
+
+            void sort();
+
+            std::vector<Sprite> sprites;
+            std::vector<uint32_t> keys;
+            std::vector<uint32_t> order, scratch;
+            std::unordered_map<SDL_Texture*, uint16_t> textureIds;
+
+            std::vector<SDL_Vertex> vertices;
+            std::vector<int> indices;
+
+            size_t lastSprites = 0;
+            size_t lastDrawCalls = 0;
+    };
+}
@@ -0,0 +1,178 @@
+#include "static_layers.h"
+#include "entity.h"
+#include "trace.h"
+#include "world.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+
+    /*
+     * chunk coordinates are clamped so far-away (or non-finite) boxes can't overflow an int.
+     */
+    static const float MAX_CHUNK = (float)(1 << 30);
+
+    int StaticLayerCache::chunkOf(float v) {
+        float c = std::floor(v / CHUNK_SIZE);
+        if (!(c > -MAX_CHUNK)) return -(int)MAX_CHUNK;
+        if (c > MAX_CHUNK) return (int)MAX_CHUNK;
+        return (int)c;
+    }
+
+    void StaticLayerCache::invalidate(const SDL_FRect& box) {
+        int x0 = chunkOf(box.x), y0 = chunkOf(box.y);
+        int x1 = chunkOf(box.x + box.w), y1 = chunkOf(box.y + box.h);
+
+        // a huge box (a level-sized background) may cover more chunks than exist; walk the existing ones instead.
+        if ((int64_t)(x1 - x0 + 1) * (y1 - y0 + 1) > (int64_t)chunks.size()) {
+            for (auto& [k, chunk] : chunks) {
+                int cx = (int)(int32_t)(k >> 32), cy = (int)(int32_t)(uint32_t)k;
+                if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1) chunk.built = false;
+            }
+            return;
+        }
+
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                auto it = chunks.find(key(cx, cy));
+                if (it != chunks.end()) it->second.built = false;
+            }
+        }
+    }
+
+    StaticLayerCache::Commands::Build& StaticLayerCache::nextBuild(Commands& out, uint64_t k, float x, float y) {
+        if (out.buildCount == out.builds.size()) out.builds.emplace_back();
+        Commands::Build& b = out.builds[out.buildCount++];
+        b.key = k;
+        b.x = x;
+        b.y = y;
+        b.layers.clear();
+        return b;
+    }
+
+    void StaticLayerCache::build(World& world, Chunk& chunk, uint64_t k, int cx, int cy, Commands& out) {
+        SDL_FRect area{(float)cx * CHUNK_SIZE, (float)cy * CHUNK_SIZE, (float)CHUNK_SIZE, (float)CHUNK_SIZE};
+        hits.clear();
+        world.queryStatic(area, hits);
+        // stable, so each layer keeps DRAW phase order.
+        std::stable_sort(hits.begin(), hits.end(), [](Entity* a, Entity* b) {return a->getLayer() < b->getLayer();});
+
+        Commands::Build& b = nextBuild(out, k, area.x, area.y);
+        for (Entity* e : hits) {
+            if (b.layers.empty() || b.layers.back() != e->getLayer()) {
+                b.layers.push_back(e->getLayer());
+                if (b.batches.size() < b.layers.size()) b.batches.emplace_back();
+                b.batches[b.layers.size() - 1].begin();
+            }
+            e->draw(b.batches[b.layers.size() - 1]);
+        }
+
+        chunk.layers = b.layers;
+        chunk.built = true;
+    }
+
+    void StaticLayerCache::record(World& world, const SDL_FRect& view, Commands& out) {
+        out.buildCount = 0;
+        out.draws.clear();
+        frame++;
+
+        changes.clear();
+        world.takeStaticChanges(changes);
+        for (const SDL_FRect& box : changes) invalidate(box);
+        if (chunks.empty() && world.getStaticCount() == 0) return;
+
+        TRACE_SCOPE("record static chunks");
+        int x0 = chunkOf(view.x), y0 = chunkOf(view.y);
+        int x1 = chunkOf(view.x + view.w), y1 = chunkOf(view.y + view.h);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                uint64_t k = key(cx, cy);
+                Chunk& chunk = chunks[k];
+                chunk.lastSeen = frame;
+                if (!chunk.built) build(world, chunk, k, cx, cy, out);
+
+                SDL_FRect dst{(float)cx * CHUNK_SIZE, (float)cy * CHUNK_SIZE, (float)CHUNK_SIZE, (float)CHUNK_SIZE};
+                for (size_t i = 0; i < chunk.layers.size(); i++) {
+                    out.draws.push_back({k, (uint32_t)i, dst, chunk.layers[i]});
+                }
+            }
+        }
+
+        // scrolling leaves chunks behind; let their textures go once they have been out of view for a while.
+        if (frame % 64 != 0) return;
+        for (auto it = chunks.begin(); it != chunks.end();) {
+            if (frame - it->second.lastSeen <= EVICT_AFTER) {
+                ++it;
+                continue;
+            }
+            if (!it->second.layers.empty()) nextBuild(out, it->first, 0, 0);
+            it = chunks.erase(it);
+        }
+    }
+
+    void StaticLayerCache::render(SDL_Renderer* renderer, Commands& commands, SpriteBatch& frame) {
+        lastRedraws = commands.buildCount;
+
+        if (commands.buildCount > 0) {
+            TRACE_SCOPE("redraw static chunks");
+            SDL_Texture* target = SDL_GetRenderTarget(renderer);
+            Uint8 r, g, b, a;
+            SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+
+            for (size_t i = 0; i < commands.buildCount; i++) {
+                Commands::Build& build = commands.builds[i];
+                std::vector<SDL_Texture*>& list = textures[build.key];
+
+                while (list.size() > build.layers.size()) {
+                    SDL_DestroyTexture(list.back());
+                    list.pop_back();
+                    textureCount--;
+                }
+                while (list.size() < build.layers.size()) {
+                    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, CHUNK_SIZE, CHUNK_SIZE);
+                    if (!texture) {
+                        SDL_Log("Can't create static chunk texture: %s", SDL_GetError());
+                        break;
+                    }
+                    // sprites blended onto a transparent target leave premultiplied color behind.
+                    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+                    list.push_back(texture);
+                    textureCount++;
+                }
+                if (list.empty()) {
+                    textures.erase(build.key);
+                    continue;
+                }
+
+                Scaling::Transform local{1.0f, 1.0f, -build.x, -build.y};
+                for (size_t j = 0; j < list.size(); j++) {
+                    SDL_SetRenderTarget(renderer, list[j]);
+                    SDL_RenderClear(renderer);
+                    build.batches[j].flush(renderer, local);
+                }
+            }
+
+            SDL_SetRenderTarget(renderer, target);
+            SDL_SetRenderDrawColor(renderer, r, g, b, a);
+        }
+
+        for (const Commands::Draw& draw : commands.draws) {
+            auto it = textures.find(draw.key);
+            if (it == textures.end() || draw.slot >= it->second.size()) continue;
+            frame.draw(it->second[draw.slot], nullptr, draw.dst, draw.layer);
+        }
+    }
+
+    void StaticLayerCache::clear() {
+        for (auto& [k, list] : textures) {
+            for (SDL_Texture* texture : list) SDL_DestroyTexture(texture);
+        }
+        textures.clear();
+        textureCount = 0;
+        lastRedraws = 0;
+        chunks.clear();
+        frame = 0;
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "sprite_batch.h"
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+    class World;
+    class Entity;
+
+    /*
+     * draws static entities (see Entity::setStatic) through cached render-target textures, so level geometry
+     * costs one quad per chunk and layer each frame instead of one per entity.
+     *
+     * the world is cut into CHUNK_SIZE square chunks. the static entities of each layer in a chunk are drawn
+     * into one texture when the chunk first comes into view, and again only when World::takeStaticChanges
+     * reports a change that touches it. chunks that stay out of view for EVICT_AFTER frames free their textures.
+     *
+     * chunks are drawn at game resolution and stretched with the rest of the frame by the scaling transform.
+     * their textures hold premultiplied alpha, so translucent sprites come out the same as drawn directly.
+     *
+     * like SpriteBatch, the work is split in two: record() reads the world (on the simulation thread when
+     * rendering is pipelined) and fills a Commands buffer that travels with the frame; render() owns the
+     * textures and runs on the main thread. Engine::main() drives both.
+     */
+    class StaticLayerCache {
+        public:
+            static const int CHUNK_SIZE = 512;
+            static const uint32_t EVICT_AFTER = 300;
+
+            /*
+             * what record() asks render() to do for one frame.
+             */
+            struct Commands {
+                /*
+                 * redraw a chunk: one batch per layer that has static entities in it, in layer order.
+                 * no layers means the chunk is now empty (or evicted) and its textures go.
+                 */
+                struct Build {
+                    uint64_t key;
+                    float x, y;
+                    std::vector<int> layers;
+                    std::vector<SpriteBatch> batches;
+                };
+
+                /*
+                 * draw texture `slot` of a chunk on `layer`.
+                 */
+                struct Draw {
+                    uint64_t key;
+                    uint32_t slot;
+                    SDL_FRect dst;
+                    int layer;
+                };
+
+                std::vector<Build> builds;
+                size_t buildCount = 0;
+                std::vector<Draw> draws;
+            };
+
+            /*
+             * queue into `out` the rebuilds of every chunk that changed and is in view, and a draw for each
+             * layer of each chunk that overlaps `view`. call after World::queryDrawable in the same frame.
+             */
+            void record(World& world, const SDL_FRect& view, Commands& out);
+
+            /*
+             * redraw the chunks `commands` asks for, then queue its chunk draws into `frame`, which is flushed after.
+             * main thread only.
+             */
+            void render(SDL_Renderer* renderer, Commands& commands, SpriteBatch& frame);
+
+            /*
+             * forget every chunk and destroy their textures. main thread only, with nothing recording.
+             */
+            void clear();
+
+            /*
+             * chunk textures alive, and chunks redrawn by the last render().
+             */
+            size_t getTextureCount() const {return textureCount;}
+            size_t getRedrawCount() const {return lastRedraws;}
+
+        private:
+            /*
+             * the recording side's view of a chunk.
+             */
+            struct Chunk {
+                bool built = false;
+                std::vector<int> layers;
+                uint32_t lastSeen = 0;
+            };
+
+            static uint64_t key(int cx, int cy) {return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;}
+            static int chunkOf(float v);
+            void invalidate(const SDL_FRect& box);
+            void build(World& world, Chunk& chunk, uint64_t k, int cx, int cy, Commands& out);
+            Commands::Build& nextBuild(Commands& out, uint64_t k, float x, float y);
+
+            // recording side
+            std::unordered_map<uint64_t, Chunk> chunks;
+            std::vector<SDL_FRect> changes;
+            std::vector<Entity*> hits;
+            uint32_t frame = 0;
+
+            // rendering side
+            std::unordered_map<uint64_t, std::vector<SDL_Texture*>> textures;
+            size_t textureCount = 0;
+            size_t lastRedraws = 0;
+    };
+}
@@ -0,0 +1,168 @@
+#include "sweep_prune.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+
+    /*
+     * sort key of a box. a NaN edge would break the ordering, so it sorts first (and never overlaps anything).
+     */
+    static float leftOf(const SDL_FRect& box) {
+        return std::isnan(box.x) ? -INFINITY : box.x;
+    }
+
+    void SweepAndPrune::clear() {
+        items.clear();
+        order.clear();
+        lefts.clear();
+        wide.clear();
+        count = 0;
+        maxWidth = 0;
+        added = stale = 0;
+        dirty = false;
+    }
+
+    void SweepAndPrune::insert(uint32_t id, const SDL_FRect& box) {
+        if (id >= items.size()) items.resize(id + 1);
+
+        Item& item = items[id];
+        bool wasWide = item.live && item.wide;
+        bool wasNarrow = item.live && !item.wide;
+        bool isWide = box.w > MAX_WIDTH;
+
+        if (!item.live) {
+            item.live = true;
+            count++;
+        }
+
+        if (wasWide && !isWide) {
+            wide.erase(std::find(wide.begin(), wide.end(), id));
+        } else if (isWide && !wasWide) {
+            wide.push_back(id);
+        }
+
+        if (wasNarrow && isWide) {
+            stale++;
+        } else if (!isWide && !wasNarrow) {
+            // an entry left behind by a remove is still in the order; it's good again.
+            if (item.listed) {
+                stale--;
+            } else {
+                item.listed = true;
+                order.push_back(id);
+                lefts.push_back(0);
+                added++;
+            }
+        }
+
+        item.box = box;
+        item.wide = isWide;
+        dirty = true;
+    }
+
+    void SweepAndPrune::remove(uint32_t id) {
+        if (!contains(id)) return;
+
+        Item& item = items[id];
+        if (item.wide) wide.erase(std::find(wide.begin(), wide.end(), id));
+        else stale++;
+
+        item.live = false;
+        count--;
+        dirty = true;
+    }
+
+    void SweepAndPrune::sort() {
+        if (!dirty) return;
+        dirty = false;
+
+        if (stale > 0) {
+            size_t kept = 0;
+            for (uint32_t id : order) {
+                if (narrow(id)) order[kept++] = id;
+                else items[id].listed = false;
+            }
+            order.resize(kept);
+            lefts.resize(kept);
+            stale = 0;
+        }
+
+        maxWidth = 0;
+        for (size_t i = 0; i < order.size(); i++) {
+            const SDL_FRect& box = items[order[i]].box;
+            lefts[i] = leftOf(box);
+            maxWidth = std::max(maxWidth, box.w);
+        }
+
+        shifts = 0;
+        if (added > order.size() / 8 + 16) {
+            // new boxes land anywhere; insertion sort would be quadratic in them.
+            std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+                return leftOf(items[a].box) < leftOf(items[b].box);
+            });
+            for (size_t i = 0; i < order.size(); i++) lefts[i] = leftOf(items[order[i]].box);
+            fullSorts++;
+        } else {
+            for (size_t i = 1; i < order.size(); i++) {
+                uint32_t id = order[i];
+                float left = lefts[i];
+                size_t j = i;
+                while (j > 0 && lefts[j - 1] > left) {
+                    order[j] = order[j - 1];
+                    lefts[j] = lefts[j - 1];
+                    j--;
+                }
+                order[j] = id;
+                lefts[j] = left;
+                shifts += i - j;
+            }
+        }
+        added = 0;
+    }
+
+    void SweepAndPrune::query(const SDL_FRect& area, std::vector<uint32_t>& out) {
+        if (count == 0) return;
+        sort();
+
+        // nothing starting a whole maxWidth left of the area can reach it.
+        auto begin = std::lower_bound(lefts.begin(), lefts.end(), area.x - maxWidth);
+        auto end = std::lower_bound(begin, lefts.end(), area.x + area.w);
+        for (auto it = begin; it != end; ++it) {
+            uint32_t id = order[it - lefts.begin()];
+            if (overlaps(items[id].box, area)) out.push_back(id);
+        }
+
+        for (uint32_t id : wide) {
+            if (overlaps(items[id].box, area)) out.push_back(id);
+        }
+    }
+
+    void SweepAndPrune::pairs(std::vector<std::pair<uint32_t, uint32_t>>& out) {
+        sort();
+
+        // `open` holds the boxes that started earlier and haven't ended by the current box's left edge.
+        open.clear();
+        for (uint32_t id : order) {
+            const SDL_FRect& a = items[id].box;
+            size_t kept = 0;
+            for (uint32_t o : open) {
+                const SDL_FRect& b = items[o].box;
+                if (b.x + b.w <= a.x) continue;
+                open[kept++] = o;
+                if (overlaps(a, b)) out.emplace_back(std::min(id, o), std::max(id, o));
+            }
+            open.resize(kept);
+            open.push_back(id);
+        }
+
+        for (uint32_t w : wide) {
+            scratch.clear();
+            query(items[w].box, scratch);
+            for (uint32_t id : scratch) {
+                // two wide boxes are reported from the lower one's turn.
+                if (id == w || (items[id].wide && id < w)) continue;
+                out.emplace_back(std::min(id, w), std::max(id, w));
+            }
+        }
+    }
+}
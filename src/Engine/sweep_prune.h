@@ -0,0 +1,97 @@
+#pragma once
+#include <SDL3/SDL_rect.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Engine {
+
+    /*
+     * axis-aligned boxes kept sorted by their left edge, keyed by small integer ids: the same queries as
+     * SpatialHash, answered by sweeping along x instead of by grid cells.
+     *
+     * suits wide, mostly horizontal levels, where boxes are spread along x and move a little each frame.
+     * moving a box only stores it. the order is repaired by insertion sort at the next query, which costs
+     * about one pass when few boxes have passed each other since the last one (a big batch of new boxes is
+     * sorted in full instead). pairs() sweeps the sorted boxes once with a list of those still open.
+     * a query binary-searches the x range, widened by the widest box in the list. boxes wider than MAX_WIDTH
+     * (a level's floor, a background) would widen every query, so they are kept in a separate list that
+     * every query checks.
+     *
+     * ids index a flat array, so keep them dense (e.g. World handle slots).
+     * not thread-safe, including query(), which may sort.
+     */
+    class SweepAndPrune {
+        public:
+            static constexpr float MAX_WIDTH = 1024.0f;
+
+            /*
+             * insert a box, or move it if the id is already present.
+             */
+            void insert(uint32_t id, const SDL_FRect& box);
+
+            /*
+             * remove a box. removing an id that isn't present does nothing.
+             */
+            void remove(uint32_t id);
+
+            bool contains(uint32_t id) const {return id < items.size() && items[id].live;}
+            size_t size() const {return count;}
+            void clear();
+
+            /*
+             * append to `out` the id of every box that overlaps `area` (touching edges don't count), each once.
+             * ids come out in no particular order.
+             */
+            void query(const SDL_FRect& area, std::vector<uint32_t>& out);
+
+            /*
+             * append to `out` every pair of boxes that overlap each other, each once, as (lower id, higher id).
+             */
+            void pairs(std::vector<std::pair<uint32_t, uint32_t>>& out);
+
+            /*
+             * places boxes moved by insertion sort in the last sort, and how many full sorts there have been.
+             * a rough measure of how much the order changes between frames.
+             */
+            size_t getShiftCount() const {return shifts;}
+            size_t getFullSortCount() const {return fullSorts;}
+
+        private:
+            struct Item {
+                SDL_FRect box;
+                bool live = false;
+                bool wide = false;
+                bool listed = false;    // present in `order`, possibly no longer narrow and live
+            };
+
+            static bool overlaps(const SDL_FRect& a, const SDL_FRect& b) {
+                return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+            }
+
+            bool narrow(uint32_t id) const {return items[id].live && !items[id].wide;}
+            void sort();
+
+            std::vector<Item> items;
+            size_t count = 0;
+
+            /*
+             * live narrow ids by left edge, with their left edges alongside, as of the last sort().
+             * stale entries (removed or widened since) are dropped by the next sort.
+             */
+            std::vector<uint32_t> order;
+            std::vector<float> lefts;
+            std::vector<uint32_t> wide;
+            float maxWidth = 0;
+            size_t added = 0;
+            size_t stale = 0;
+            bool dirty = false;
+
+            size_t shifts = 0;
+            size_t fullSorts = 0;
+
+            std::vector<uint32_t> open;
+            std::vector<uint32_t> scratch;
+    };
+}
@@ -0,0 +1,212 @@
+#include "text.h"
+#include "core.h"
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+
+    /*
+     * decode the UTF-8 code point at `s` and step past it. malformed bytes come out as U+FFFD, one byte at a time.
+     */
+    static uint32_t nextCodepoint(const char*& s) {
+        const unsigned char* p = (const unsigned char*)s;
+        uint32_t c = p[0];
+        int extra = c < 0x80 ? 0 : (c & 0xe0) == 0xc0 ? 1 : (c & 0xf0) == 0xe0 ? 2 : (c & 0xf8) == 0xf0 ? 3 : -1;
+        if (extra < 0) {
+            s++;
+            return 0xfffd;
+        }
+
+        c &= 0x7f >> extra;
+        for (int i = 1; i <= extra; i++) {
+            if ((p[i] & 0xc0) != 0x80) {
+                s++;
+                return 0xfffd;
+            }
+            c = (c << 6) | (p[i] & 0x3f);
+        }
+        s += extra + 1;
+        return c;
+    }
+
+    static void encode(uint32_t c, char out[5]) {
+        if (c < 0x80) {
+            out[0] = (char)c; out[1] = 0;
+        } else if (c < 0x800) {
+            out[0] = (char)(0xc0 | (c >> 6)); out[1] = (char)(0x80 | (c & 0x3f)); out[2] = 0;
+        } else if (c < 0x10000) {
+            out[0] = (char)(0xe0 | (c >> 12)); out[1] = (char)(0x80 | ((c >> 6) & 0x3f));
+            out[2] = (char)(0x80 | (c & 0x3f)); out[3] = 0;
+        } else {
+            out[0] = (char)(0xf0 | (c >> 18)); out[1] = (char)(0x80 | ((c >> 12) & 0x3f));
+            out[2] = (char)(0x80 | ((c >> 6) & 0x3f)); out[3] = (char)(0x80 | (c & 0x3f)); out[4] = 0;
+        }
+    }
+
+    Font::~Font() {
+        close();
+    }
+
+    bool Font::open(const std::string& file, float size) {
+        // SDL_ttf counts its inits; every open font holds one.
+        if (!TTF_Init()) {
+            SDL_Log("Can't initialize SDL_ttf: %s", SDL_GetError());
+            return false;
+        }
+        TTF_Font* opened = TTF_OpenFont(file.c_str(), size);
+        if (!opened) {
+            SDL_Log("Can't open font %s: %s", file.c_str(), SDL_GetError());
+            TTF_Quit();
+            return false;
+        }
+
+        close();
+        font = opened;
+        lineHeight = (float)TTF_GetFontLineSkip(font);
+        return true;
+    }
+
+    void Font::close() {
+        if (font) {
+            TTF_CloseFont(font);
+            TTF_Quit();
+            font = nullptr;
+        }
+        lineHeight = SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE;
+        forget();
+    }
+
+    void Font::forget() {
+        // a renderer takes its textures with it when it's destroyed.
+        if (owner && owner == renderer) atlas.clear();
+        else atlas.abandon();
+        owner = nullptr;
+
+        for (Glyph& g : ascii) g = Glyph{};
+        glyphs.clear();
+        glyphCount = 0;
+    }
+
+    const Font::Glyph& Font::glyph(uint32_t codepoint) {
+        if (owner != renderer) {
+            forget();
+            owner = renderer;
+        }
+
+        Glyph& g = codepoint < 128 ? ascii[codepoint] : glyphs[codepoint];
+        if (!g.loaded) {
+            g.loaded = true;
+            rasterize(codepoint, g);
+            glyphCount++;
+        }
+        return g;
+    }
+
+    bool Font::rasterize(uint32_t codepoint, Glyph& g) {
+        SDL_Texture* source = nullptr;
+        int w = 0, h = 0;
+
+        if (font) {
+            int minX, maxX, minY, maxY, advance;
+            if (!TTF_GetGlyphMetrics(font, codepoint, &minX, &maxX, &minY, &maxY, &advance)) return false;
+            g.advance = (float)advance;
+            if (!renderer || maxX <= minX) return true;
+
+            // rendered a line high with the glyph on the baseline, so it's drawn at the top of the line.
+            SDL_Surface* surface = TTF_RenderGlyph_Blended(font, codepoint, SDL_Color{255, 255, 255, 255});
+            if (!surface) {
+                SDL_Log("Can't render glyph U+%04X: %s", codepoint, SDL_GetError());
+                return false;
+            }
+            w = surface->w;
+            h = surface->h;
+            source = SDL_CreateTextureFromSurface(renderer, surface);
+            SDL_DestroySurface(surface);
+        } else {
+            const int size = SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE;
+            g.advance = (float)size;
+            if (!renderer || codepoint <= ' ') return true;
+
+            w = h = size;
+            source = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size, size);
+            if (source) {
+                char utf8[5];
+                encode(codepoint, utf8);
+
+                SDL_Texture* target = SDL_GetRenderTarget(renderer);
+                Uint8 r, gr, b, a;
+                SDL_GetRenderDrawColor(renderer, &r, &gr, &b, &a);
+                SDL_SetRenderTarget(renderer, source);
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+                SDL_RenderClear(renderer);
+                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+                SDL_RenderDebugText(renderer, 0, 0, utf8);
+                SDL_SetRenderDrawColor(renderer, r, gr, b, a);
+                SDL_SetRenderTarget(renderer, target);
+            }
+        }
+
+        if (!source) {
+            SDL_Log("Can't create glyph texture: %s", SDL_GetError());
+            return false;
+        }
+        g.region = atlas.add(source, w, h);
+        SDL_DestroyTexture(source);
+        return (bool)g.region;
+    }
+
+    float Font::kerning(uint32_t previous, uint32_t codepoint) const {
+        int k = 0;
+        if (!font || previous == 0 || !TTF_GetGlyphKerning(font, previous, codepoint, &k)) return 0;
+        return (float)k;
+    }
+
+    void Font::draw(SpriteBatch& batch, const char* text, float x, float y, SDL_FColor color, int layer) {
+        if (!text) return;
+
+        float penX = x, penY = y;
+        uint32_t previous = 0;
+        while (*text) {
+            uint32_t c = nextCodepoint(text);
+            if (c == '\n') {
+                penX = x;
+                penY += lineHeight;
+                previous = 0;
+                continue;
+            }
+
+            const Glyph& g = glyph(c);
+            penX += kerning(previous, c);
+            if (g.region) {
+                // whole pixels keep the glyphs sharp.
+                SDL_FRect dst{std::round(penX), std::round(penY), g.region.src.w, g.region.src.h};
+                batch.draw(g.region.texture, &g.region.src, dst, layer, color);
+            }
+            penX += g.advance;
+            previous = c;
+        }
+    }
+
+    SDL_FPoint Font::measure(const char* text) {
+        if (!text || !*text) return {0, 0};
+
+        float width = 0, lineWidth = 0;
+        int lines = 1;
+        uint32_t previous = 0;
+        while (*text) {
+            uint32_t c = nextCodepoint(text);
+            if (c == '\n') {
+                width = std::max(width, lineWidth);
+                lineWidth = 0;
+                lines++;
+                previous = 0;
+                continue;
+            }
+            lineWidth += kerning(previous, c) + glyph(c).advance;
+            previous = c;
+        }
+        return {std::max(width, lineWidth), lines * lineHeight};
+    }
+}
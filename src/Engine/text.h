@@ -0,0 +1,98 @@
+#pragma once
+#include "atlas.h"
+#include "sprite_batch.h"
+#include <SDL3/SDL_pixels.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+typedef struct TTF_Font TTF_Font;
+
+namespace Engine {
+
+    /*
+     * draws strings as quads from a glyph atlas, so text that changes every frame (overlays, HUDs)
+     * costs a SpriteBatch run instead of rasterizing it again each frame.
+     *
+     * each glyph is rasterized once, white, the first time it's drawn or measured, and packed into the font's
+     * AtlasPacker; draw() then queues one quad per glyph, tinted with the text color. a whole string, usually
+     * a whole overlay, ends up as one SDL_RenderGeometry call.
+     *
+     * a font opened from a TTF file (through SDL_ttf) is used at one point size. a font that isn't open uses
+     * SDL's built-in 8x8 debug font, so text works without any font file.
+     *
+     * glyphs are rasterized with the render API, so draw() and measure() are main thread only.
+     * the atlas belongs to the renderer it was made with and is forgotten if the engine's renderer changes.
+     */
+    class Font {
+        public:
+            Font() = default;
+            ~Font();
+
+            Font(const Font&) = delete;
+            Font& operator=(const Font&) = delete;
+
+            /*
+             * load a TTF/OTF file at `size` points, replacing whatever font was open.
+             * returns false (and logs why) if it can't be loaded, leaving the built-in font in use.
+             */
+            bool open(const std::string& file, float size);
+
+            /*
+             * go back to the built-in font.
+             */
+            void close();
+
+            /*
+             * whether a TTF font is open (rather than the built-in one).
+             */
+            bool isOpen() const {return font != nullptr;}
+
+            /*
+             * queue `text` (UTF-8, '\n' starts a new line) with the top-left of its first line at (x, y),
+             * in the batch's coordinates.
+             */
+            void draw(SpriteBatch& batch, const char* text, float x, float y,
+                      SDL_FColor color = {1.0f, 1.0f, 1.0f, 1.0f}, int layer = 0);
+
+            /*
+             * width of the widest line and total height of `text`, in pixels.
+             */
+            SDL_FPoint measure(const char* text);
+
+            /*
+             * distance between the tops of two lines.
+             */
+            float getLineHeight() const {return lineHeight;}
+
+            /*
+             * glyphs rasterized so far, and the atlas pages holding them.
+             */
+            size_t getGlyphCount() const {return glyphCount;}
+            size_t getPageCount() const {return atlas.getPageCount();}
+
+        private:
+            struct Glyph {
+                TextureRegion region;   // empty for glyphs with nothing to draw (e.g. space)
+                float advance = 0;
+                bool loaded = false;
+            };
+
+            const Glyph& glyph(uint32_t codepoint);
+            bool rasterize(uint32_t codepoint, Glyph& g);
+            float kerning(uint32_t previous, uint32_t codepoint) const;
+            void forget();
+
+            TTF_Font* font = nullptr;
+            float lineHeight = SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE;
+
+            AtlasPacker atlas{512, 1};
+            SDL_Renderer* owner = nullptr;
+            Glyph ascii[128];
+            std::unordered_map<uint32_t, Glyph> glyphs;
+            size_t glyphCount = 0;
+    };
+}
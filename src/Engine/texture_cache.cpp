@@ -0,0 +1,467 @@
+#include "texture_cache.h"
+#include "asset_pack.h"
+#include "core.h"
+#include "trace.h"
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine::Textures {
+
+    struct Entry {
+        TextureRegion region;
+        int refs = 0;
+        bool atlas = false;
+    };
+
+    using Key = std::tuple<std::string, int, int>;
+
+    static std::map<Key, Entry> sEntries;
+    static std::unordered_map<std::string, SDL_Texture*> sSources;
+    static std::unique_ptr<AtlasPacker> sAtlas;
+    static bool sAtlasEnabled = true;
+    static int sAtlasMaxSprite = 512;
+    static AssetPack sPack;
+
+    /*
+     * async loading. requests and releases can come from any thread and are handed to the main thread
+     * through the queues under sLoadMx; loader threads take paths from sDecodeQueue and leave surfaces in sDecoded.
+     * everything below the lock's members is only touched by the main thread, in pump().
+     */
+    struct Request {
+        std::string path;
+        int w, h;
+        OnReady onReady;
+    };
+
+    static const int LOADER_THREADS = 2;
+
+    static std::mutex sLoadMx;
+    static std::condition_variable sLoadCv;
+    static std::vector<Request> sRequests;
+    static std::vector<TextureRegion> sReleases;
+    static bool sTrimQueued = false;
+    static std::deque<std::string> sDecodeQueue;
+    static std::vector<std::pair<std::string, SDL_Surface*>> sDecoded;
+    static bool sLoaderQuit = false;
+
+    static std::vector<std::thread> sLoaders;
+    static std::unordered_map<std::string, std::vector<Request>> sWaiting;
+    static std::deque<std::pair<std::string, SDL_Surface*>> sUploads;
+    static std::deque<Request> sReady;
+    static std::atomic<size_t> sPending{0};
+    static double sUploadBudget = 2.0;
+
+    static TextureRegion sPlaceholder;
+    static std::thread::id sMainThread;
+
+    /*
+     * a texture holding an image from the asset pack, uploaded straight from the mapped file.
+     */
+    static SDL_Texture* upload(const PackedImage& image) {
+        SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, image.w, image.h);
+        if (!texture) {
+            SDL_Log("Can't create texture: %s", SDL_GetError());
+            return nullptr;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        SDL_UpdateTexture(texture, nullptr, image.pixels, image.pitch);
+        return texture;
+    }
+
+    /*
+     * the decoded image at `path`, loaded on first use (from the asset pack if it has it) and kept until trim().
+     */
+    static SDL_Texture* source(const std::string& path) {
+        auto it = sSources.find(path);
+        if (it != sSources.end()) return it->second;
+
+        SDL_Texture* texture;
+        if (PackedImage image = sPack.find(path)) texture = upload(image);
+        else texture = IMG_LoadTexture(renderer, path.c_str());
+        if (!texture) {
+            SDL_Log("failed to load texture %s: %s", path.c_str(), SDL_GetError());
+            return nullptr;
+        }
+        sSources[path] = texture;
+        return texture;
+    }
+
+    /*
+     * a standalone w x h copy of `src`.
+     */
+    static SDL_Texture* copy(SDL_Texture* src, int w, int h) {
+        SDL_Texture* out = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (!out) {
+            SDL_Log("Can't create texture: %s", SDL_GetError());
+            return nullptr;
+        }
+        SDL_SetTextureBlendMode(out, SDL_BLENDMODE_BLEND);
+
+        SDL_BlendMode blend;
+        SDL_GetTextureBlendMode(src, &blend);
+        SDL_SetTextureBlendMode(src, SDL_BLENDMODE_NONE);
+        SDL_Texture* target = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, out);
+        SDL_FRect dst{0, 0, (float)w, (float)h};
+        SDL_RenderTexture(renderer, src, nullptr, &dst);
+        SDL_SetRenderTarget(renderer, target);
+        SDL_SetTextureBlendMode(src, blend);
+        return out;
+    }
+
+    TextureRegion acquire(const std::string& path, int w, int h) {
+        if (!renderer) return {};
+
+        if (w <= 0 || h <= 0) {
+            int imageW, imageH;
+            if (!getImageSize(path, imageW, imageH)) return {};
+            if (w <= 0 && h <= 0) {
+                w = imageW;
+                h = imageH;
+            } else if (w <= 0) {
+                w = std::max(1, (int)(imageW * (float)h / imageH + 0.5f));
+            } else {
+                h = std::max(1, (int)(imageH * (float)w / imageW + 0.5f));
+            }
+        }
+
+        // a cached texture doesn't need the source, which trim() may have dropped.
+        auto it = sEntries.find({path, w, h});
+        if (it != sEntries.end()) {
+            it->second.refs++;
+            return it->second.region;
+        }
+
+        // the pack may have the image at exactly this size already; then it is used as it is, with no scaling pass.
+        SDL_Texture* exact = nullptr;
+        if (PackedImage image = sPack.find(path, w, h)) exact = upload(image);
+        SDL_Texture* src = exact ? exact : source(path);
+        if (!src) return {};
+
+        Entry& entry = sEntries[{path, w, h}];
+        if (sAtlasEnabled && w <= sAtlasMaxSprite && h <= sAtlasMaxSprite) {
+            if (!sAtlas) sAtlas = std::make_unique<AtlasPacker>();
+            entry.region = sAtlas->add(src, w, h);
+            entry.atlas = (bool)entry.region;
+        }
+        if (!entry.region && exact) {
+            entry.region = {exact, {0, 0, (float)w, (float)h}};
+            exact = nullptr;
+        }
+        if (!entry.region) {
+            entry.region.texture = copy(src, w, h);
+            entry.region.src = {0, 0, (float)w, (float)h};
+        }
+        if (exact) SDL_DestroyTexture(exact);
+        if (!entry.region) {
+            sEntries.erase({path, w, h});
+            return {};
+        }
+
+        entry.refs++;
+        return entry.region;
+    }
+
+    void release(const TextureRegion& region) {
+        if (!region || region.texture == sPlaceholder.texture) return;
+
+        if (std::this_thread::get_id() != sMainThread) {
+            std::lock_guard<std::mutex> lk(sLoadMx);
+            sReleases.push_back(region);
+            return;
+        }
+
+        // releases are rare (entity destruction), so a scan beats keeping a second index in sync.
+        for (auto it = sEntries.begin(); it != sEntries.end(); ++it) {
+            Entry& entry = it->second;
+            if (entry.region.texture != region.texture || entry.region.src.x != region.src.x ||
+                entry.region.src.y != region.src.y) continue;
+
+            if (entry.refs > 0) entry.refs--;
+            if (entry.refs == 0 && !entry.atlas) {
+                SDL_DestroyTexture(entry.region.texture);
+                sEntries.erase(it);
+            }
+            return;
+        }
+    }
+
+    bool getImageSize(const std::string& path, int& w, int& h) {
+        if (sPack.getImageSize(path, w, h)) return true;
+
+        auto it = sSources.find(path);
+        if (it != sSources.end()) {
+            w = it->second->w;
+            h = it->second->h;
+            return true;
+        }
+
+        if (!renderer) {
+            SDL_Surface* surface = IMG_Load(path.c_str());
+            if (!surface) return false;
+            w = surface->w;
+            h = surface->h;
+            SDL_DestroySurface(surface);
+            return true;
+        }
+
+        SDL_Texture* src = source(path);
+        if (!src) return false;
+        w = src->w;
+        h = src->h;
+        return true;
+    }
+
+    /*
+     * whether acquire(path, w, h) can be answered without decoding a file: the texture or its source is loaded,
+     * or the asset pack has the image.
+     */
+    static bool isCached(const std::string& path, int w, int h) {
+        return sSources.count(path) || (w > 0 && h > 0 && sEntries.count({path, w, h})) || sPack.contains(path);
+    }
+
+    static void loaderLoop() {
+        TRACE_THREAD("texture loader");
+        std::unique_lock<std::mutex> lk(sLoadMx);
+        while (true) {
+            sLoadCv.wait(lk, [] {return sLoaderQuit || !sDecodeQueue.empty();});
+            if (sLoaderQuit) return;
+
+            std::string path = std::move(sDecodeQueue.front());
+            sDecodeQueue.pop_front();
+            lk.unlock();
+
+            SDL_Surface* surface;
+            {
+                TRACE_SCOPE("decode image");
+                surface = IMG_Load(path.c_str());
+            }
+            if (!surface) SDL_Log("failed to load image %s: %s", path.c_str(), SDL_GetError());
+
+            lk.lock();
+            sDecoded.push_back({std::move(path), surface});
+        }
+    }
+
+    static void stopLoaders() {
+        {
+            std::lock_guard<std::mutex> lk(sLoadMx);
+            sLoaderQuit = true;
+        }
+        sLoadCv.notify_all();
+        for (std::thread& t : sLoaders) t.join();
+        sLoaders.clear();
+        sLoaderQuit = false;
+    }
+
+    TextureRegion placeholder() {
+        if (!sPlaceholder && renderer) {
+            sMainThread = std::this_thread::get_id();
+
+            const int SIZE = 4;
+            SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, SIZE, SIZE);
+            if (!texture) {
+                SDL_Log("Can't create placeholder texture: %s", SDL_GetError());
+                return {};
+            }
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+            SDL_Texture* target = SDL_GetRenderTarget(renderer);
+            Uint8 r, g, b, a;
+            SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+            SDL_SetRenderTarget(renderer, texture);
+            SDL_SetRenderDrawColor(renderer, 128, 128, 128, 96);
+            SDL_RenderClear(renderer);
+            SDL_SetRenderDrawColor(renderer, r, g, b, a);
+            SDL_SetRenderTarget(renderer, target);
+
+            sPlaceholder = {texture, {0, 0, (float)SIZE, (float)SIZE}};
+        }
+        return sPlaceholder;
+    }
+
+    TextureRegion acquireAsync(const std::string& path, int w, int h, OnReady onReady) {
+        if (!renderer) {
+            if (onReady) onReady({});
+            return {};
+        }
+
+        if (std::this_thread::get_id() == sMainThread && isCached(path, w, h)) {
+            TextureRegion region = acquire(path, w, h);
+            if (onReady) onReady(region);
+            return sPlaceholder;
+        }
+
+        sPending++;
+        std::lock_guard<std::mutex> lk(sLoadMx);
+        sRequests.push_back({path, w, h, std::move(onReady)});
+        return sPlaceholder;
+    }
+
+    void pump(double budgetMs) {
+        std::vector<Request> requests;
+        std::vector<TextureRegion> releases;
+        bool trimQueued;
+        {
+            std::lock_guard<std::mutex> lk(sLoadMx);
+            requests.swap(sRequests);
+            releases.swap(sReleases);
+            trimQueued = sTrimQueued;
+            sTrimQueued = false;
+            for (auto& decoded : sDecoded) sUploads.push_back(std::move(decoded));
+            sDecoded.clear();
+        }
+
+        for (const TextureRegion& region : releases) release(region);
+        if (trimQueued) trim();
+
+        bool queued = false;
+        for (Request& request : requests) {
+            if (isCached(request.path, request.w, request.h)) {
+                sReady.push_back(std::move(request));
+                continue;
+            }
+
+            // one decode per file, however many sizes of it are waiting.
+            std::vector<Request>& waiting = sWaiting[request.path];
+            if (waiting.empty()) {
+                std::lock_guard<std::mutex> lk(sLoadMx);
+                sDecodeQueue.push_back(request.path);
+                queued = true;
+            }
+            waiting.push_back(std::move(request));
+        }
+        if (queued) {
+            while (sLoaders.size() < LOADER_THREADS) sLoaders.emplace_back(loaderLoop);
+            sLoadCv.notify_all();
+        }
+
+        if (sUploads.empty() && sReady.empty()) return;
+
+        TRACE_SCOPE("texture uploads");
+        auto start = std::chrono::steady_clock::now();
+        bool worked = false;
+        auto overBudget = [&] {
+            return worked && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() > budgetMs;
+        };
+
+        while (!sUploads.empty() && !overBudget()) {
+            auto [path, surface] = std::move(sUploads.front());
+            sUploads.pop_front();
+            worked = true;
+
+            if (surface) {
+                SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+                SDL_DestroySurface(surface);
+                if (!texture) SDL_Log("Can't upload texture %s: %s", path.c_str(), SDL_GetError());
+                else if (!sSources.emplace(path, texture).second) SDL_DestroyTexture(texture);
+            }
+
+            // failed loads go through too, and get an empty region.
+            auto waiting = sWaiting.find(path);
+            if (waiting == sWaiting.end()) continue;
+            for (Request& request : waiting->second) sReady.push_back(std::move(request));
+            sWaiting.erase(waiting);
+        }
+
+        while (!sReady.empty() && !overBudget()) {
+            Request request = std::move(sReady.front());
+            sReady.pop_front();
+            worked = true;
+
+            TextureRegion region = isCached(request.path, request.w, request.h) ? acquire(request.path, request.w, request.h) : TextureRegion{};
+            sPending--;
+            if (request.onReady) request.onReady(region);
+        }
+    }
+
+    void setUploadBudget(double ms) {sUploadBudget = ms;}
+    double getUploadBudget() {return sUploadBudget;}
+    size_t getPendingCount() {return sPending.load();}
+
+    void trim() {
+        if (std::this_thread::get_id() != sMainThread) {
+            std::lock_guard<std::mutex> lk(sLoadMx);
+            sTrimQueued = true;
+            return;
+        }
+
+        for (auto& [path, texture] : sSources) SDL_DestroyTexture(texture);
+        sSources.clear();
+
+        if (!sAtlas) return;
+        for (size_t i = sAtlas->getPageCount(); i-- > 0;) {
+            SDL_Texture* page = sAtlas->getPage(i);
+
+            bool used = false;
+            for (auto& [key, entry] : sEntries) {
+                if (entry.region.texture == page && entry.refs > 0) used = true;
+            }
+            if (used) continue;
+
+            for (auto it = sEntries.begin(); it != sEntries.end();) {
+                if (it->second.region.texture == page) it = sEntries.erase(it);
+                else ++it;
+            }
+            sAtlas->removePage(page);
+        }
+    }
+
+    void clear() {
+        stopLoaders();
+        {
+            std::lock_guard<std::mutex> lk(sLoadMx);
+            for (auto& [path, surface] : sDecoded) SDL_DestroySurface(surface);
+            sDecoded.clear();
+            sDecodeQueue.clear();
+            sRequests.clear();
+            sReleases.clear();
+            sTrimQueued = false;
+        }
+        for (auto& [path, surface] : sUploads) SDL_DestroySurface(surface);
+        sUploads.clear();
+        sWaiting.clear();
+        sReady.clear();
+        sPending = 0;
+
+        if (sPlaceholder) SDL_DestroyTexture(sPlaceholder.texture);
+        sPlaceholder = {};
+
+        for (auto& [key, entry] : sEntries) {
+            if (!entry.atlas) SDL_DestroyTexture(entry.region.texture);
+        }
+        sEntries.clear();
+        sAtlas.reset();
+        for (auto& [path, texture] : sSources) SDL_DestroyTexture(texture);
+        sSources.clear();
+    }
+
+    bool mountPack(const std::string& file) {
+        return sPack.open(file);
+    }
+
+    void unmountPack() {
+        sPack.close();
+    }
+
+    bool isPackMounted() {return sPack.isOpen();}
+
+    void setAtlasEnabled(bool enabled) {sAtlasEnabled = enabled;}
+    void setAtlasMaxSprite(int pixels) {sAtlasMaxSprite = pixels;}
+    int getAtlasMaxSprite() {return sAtlasMaxSprite;}
+
+    size_t getCount() {return sEntries.size();}
+    size_t getAtlasPageCount() {return sAtlas ? sAtlas->getPageCount() : 0;}
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "atlas.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+/*
+ * reference-counted cache of textures loaded from image files.
+ *
+ * a texture is keyed by (path, target size): asking for the same image at the same size again returns the
+ * same texture, and each image file is decoded once no matter how many sizes are made from it.
+ * sprites up to getAtlasMaxSprite() pixels on a side are packed into shared atlas pages (see AtlasPacker),
+ * so entities using different images can still be drawn in one batch; anything larger gets a texture of its own.
+ *
+ * images can also be loaded in the background with acquireAsync(): files are decoded on loader threads
+ * and turned into textures by pump(), which Engine::main() calls once per frame within an upload budget.
+ *
+ * with an asset pack mounted (see AssetPack), images it holds are uploaded from its pre-decoded pixels instead,
+ * without touching their files; anything it doesn't hold still loads from disk.
+ *
+ * everything except acquireAsync(), release() and trim() uses the render API, so call it on the main thread
+ * (e.g. during setup, not from a pipelined update).
+ */
+namespace Engine::Textures {
+
+    /*
+     * get the image at `path`, scaled to w x h, and add a reference. 0 for one side keeps the image's
+     * aspect ratio, 0 for both keeps its size. returns an empty region if the image can't be loaded or there is no renderer.
+     */
+    TextureRegion acquire(const std::string& path, int w = 0, int h = 0);
+
+    /*
+     * like acquire(), without blocking on the file: returns placeholder() and calls onReady on the main thread
+     * with the real region (a reference the caller owns, as from acquire()) once it has been decoded and uploaded,
+     * or with an empty region if it can't be loaded.
+     * if the texture is already cached and this is the main thread, onReady runs before this returns.
+     * safe to call from any thread, e.g. a pipelined update.
+     */
+    using OnReady = std::function<void(const TextureRegion&)>;
+    TextureRegion acquireAsync(const std::string& path, int w, int h, OnReady onReady);
+
+    /*
+     * drop a reference taken with acquire(). standalone textures are destroyed with their last reference;
+     * atlas sprites keep their space until trim() finds their whole page unused.
+     * off the main thread the release is queued until the next pump().
+     */
+    void release(const TextureRegion& region);
+
+    /*
+     * the small translucent texture handed out while an async load is pending. created by Engine::init().
+     */
+    TextureRegion placeholder();
+
+    /*
+     * upload finished async loads and run their callbacks, for at most `budgetMs` (at least one upload
+     * happens if any is ready, so loading always makes progress). called by Engine::main() each frame
+     * with getUploadBudget(); call it yourself when driving the engine with step().
+     */
+    void pump(double budgetMs);
+
+    /*
+     * per-frame time Engine::main() gives pump(), in milliseconds. defaults to 2.
+     */
+    void setUploadBudget(double ms);
+    double getUploadBudget();
+
+    /*
+     * async loads requested but not yet handed to their callback.
+     */
+    size_t getPendingCount();
+
+    /*
+     * size in pixels of the image at `path`, loading it if needed. returns false if it can't be loaded.
+     */
+    bool getImageSize(const std::string& path, int& w, int& h);
+
+    /*
+     * free what nothing references anymore: the decoded source images, and atlas pages none of whose sprites are in use.
+     * call it after loading a level, once every size of every image has been made (getPendingCount() is 0).
+     * off the main thread it is queued until the next pump().
+     */
+    void trim();
+
+    /*
+     * destroy every cached texture, referenced or not, and drop pending async loads without calling them back.
+     * called by Engine::quit().
+     */
+    void clear();
+
+    /*
+     * use the asset pack at `file` for every load from now on, replacing any pack already mounted.
+     * returns false if it can't be opened, in which case images keep loading from their files.
+     * mount it before the first acquire; textures already made from files stay as they are.
+     */
+    bool mountPack(const std::string& file);
+    void unmountPack();
+    bool isPackMounted();
+
+    /*
+     * whether small sprites go into the atlas (default on), and the largest side that still does (default 512).
+     * only affects textures created afterwards.
+     */
+    void setAtlasEnabled(bool enabled);
+    void setAtlasMaxSprite(int pixels);
+    int getAtlasMaxSprite();
+
+    /*
+     * number of cached textures (one per (path, size) key), and atlas pages in use.
+     */
+    size_t getCount();
+    size_t getAtlasPageCount();
+}
@@ -17,6 +17,7 @@ namespace Engine {
 
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - _last_t);
         double frame_time = duration.count() / 1000.0;
+        double raw_time = std::chrono::duration<double>(now - _last_t).count();
 
         _last_t = now;
 
@@ -26,8 +27,10 @@ namespace Engine {
 
         if (_paused) {
             _delta = 0.0;
+            _frame = 0.0;
         } else {
             _delta = frame_time * _scale;
+            _frame = raw_time * _scale;
             _accum += _delta;
         }
     }
@@ -45,10 +48,12 @@ namespace Engine {
     void Timeline::togglePause() { _paused = !_paused; }
     bool Timeline::isPaused() const { return _paused; }
     double Timeline::getDelta() const { return _delta; }
+    double Timeline::getFrameTime() const { return _frame; }
     double Timeline::now() const { return _accum; }
 
     void Timeline::reset() {
         _delta = 0.016;
+        _frame = 0.0;
         _accum = 0.0;
         _last_t = std::chrono::system_clock::now();
     }
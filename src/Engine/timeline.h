@@ -28,6 +28,13 @@ namespace Engine {
         bool isPaused() const;
 
         double getDelta() const;
+
+        /**
+         * unclamped, scaled duration of the last tick in seconds (0 while paused).
+         * getDelta() clamps hitches to 33 ms; fixed-step accumulators use this instead
+         * so that no simulated time is lost.
+         */
+        double getFrameTime() const;
         double now() const;
         void reset();
 
@@ -36,6 +43,7 @@ namespace Engine {
         double _scale = 1.0;
         bool   _paused = false;
         double _delta = 0.0;
+        double _frame = 0.0;
         double _accum = 0.0;
         time_point _last_t;
     };
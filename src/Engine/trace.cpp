@@ -0,0 +1,177 @@
+#include "trace.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace Engine::Trace {
+
+    std::atomic<bool> enabled{false};
+
+    namespace {
+        struct Event {
+            const char* name;
+            int64_t ts;     // ns since start()
+            int64_t dur;    // ns, for spans
+            double value;   // for counters
+            char phase;     // Chrome trace "ph": X, i or C
+        };
+
+        /*
+         * one thread's events. only the owning thread appends; `count` is published with release
+         * so write() can read [0, count) from another thread.
+         */
+        struct Buffer {
+            std::vector<Event> events;
+            std::atomic<size_t> count{0};
+            std::atomic<size_t> dropped{0};
+            std::atomic<uint32_t> epoch{0};
+            uint32_t tid = 0;
+            const char* threadName = nullptr;
+        };
+
+        std::mutex sRegistryMx;
+        std::vector<std::shared_ptr<Buffer>> sBuffers;
+        std::atomic<uint32_t> sEpoch{0};
+        std::atomic<size_t> sCapacity{1 << 16};
+        std::atomic<int64_t> sOrigin{0};
+
+        int64_t toNs(Clock::time_point t) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+        }
+
+        /*
+         * the calling thread's buffer, registered on first use. the registry keeps it alive after the thread exits.
+         */
+        Buffer& local() {
+            thread_local std::shared_ptr<Buffer> buffer = [] {
+                auto b = std::make_shared<Buffer>();
+                std::lock_guard<std::mutex> lk(sRegistryMx);
+                b->tid = (uint32_t)sBuffers.size() + 1;
+                sBuffers.push_back(b);
+                return b;
+            }();
+            return *buffer;
+        }
+
+        void record(const Event& e) {
+            Buffer& b = local();
+
+            // first event since start(): recycle the buffer for the new trace.
+            uint32_t epoch = sEpoch.load(std::memory_order_acquire);
+            if (b.epoch.load(std::memory_order_relaxed) != epoch) {
+                size_t capacity = sCapacity.load(std::memory_order_relaxed);
+                if (b.events.size() != capacity) b.events.assign(capacity, Event{});
+                b.count.store(0, std::memory_order_relaxed);
+                b.dropped.store(0, std::memory_order_relaxed);
+                b.epoch.store(epoch, std::memory_order_release);
+            }
+
+            size_t n = b.count.load(std::memory_order_relaxed);
+            if (n >= b.events.size()) {
+                b.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            b.events[n] = e;
+            b.count.store(n + 1, std::memory_order_release);
+        }
+
+        void writeEscaped(FILE* f, const char* s) {
+            for (; *s; s++) {
+                if (*s == '"' || *s == '\\') std::fputc('\\', f);
+                if ((unsigned char)*s >= 0x20) std::fputc(*s, f);
+            }
+        }
+    }
+
+    void start(size_t eventsPerThread) {
+        sCapacity.store(eventsPerThread > 0 ? eventsPerThread : 1);
+        sOrigin.store(toNs(Clock::now()));
+        sEpoch.fetch_add(1, std::memory_order_release);
+        enabled.store(true);
+    }
+
+    void stop() {
+        enabled.store(false);
+    }
+
+    void setThreadName(const char* name) {
+        Buffer& b = local();
+        std::lock_guard<std::mutex> lk(sRegistryMx);
+        b.threadName = name;
+    }
+
+    void complete(const char* name, Clock::time_point begin, Clock::time_point end) {
+        if (!isEnabled()) return;
+        int64_t ts = toNs(begin) - sOrigin.load(std::memory_order_relaxed);
+        record({name, ts, toNs(end) - toNs(begin), 0.0, 'X'});
+    }
+
+    void instant(const char* name) {
+        if (!isEnabled()) return;
+        record({name, toNs(Clock::now()) - sOrigin.load(std::memory_order_relaxed), 0, 0.0, 'i'});
+    }
+
+    void counter(const char* name, double value) {
+        if (!isEnabled()) return;
+        record({name, toNs(Clock::now()) - sOrigin.load(std::memory_order_relaxed), 0, value, 'C'});
+    }
+
+    bool write(const std::string& filename) {
+        FILE* f = std::fopen(filename.c_str(), "w");
+        if (!f) return false;
+
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lk(sRegistryMx);
+            buffers = sBuffers;
+        }
+        uint32_t epoch = sEpoch.load(std::memory_order_acquire);
+
+        std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        auto separator = [&] {
+            if (!first) std::fprintf(f, ",\n");
+            first = false;
+        };
+
+        for (auto& b : buffers) {
+            const char* threadName;
+            {
+                std::lock_guard<std::mutex> lk(sRegistryMx);
+                threadName = b->threadName;
+            }
+            if (threadName) {
+                separator();
+                std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", b->tid);
+                writeEscaped(f, threadName);
+                std::fprintf(f, "\"}}");
+            }
+            if (b->epoch.load(std::memory_order_acquire) != epoch) continue;
+
+            size_t n = b->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; i++) {
+                const Event& e = b->events[i];
+                separator();
+                std::fprintf(f, "{\"name\":\"");
+                writeEscaped(f, e.name);
+                std::fprintf(f, "\",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", e.phase, b->tid, e.ts / 1000.0);
+                if (e.phase == 'X') std::fprintf(f, ",\"dur\":%.3f", e.dur / 1000.0);
+                if (e.phase == 'i') std::fprintf(f, ",\"s\":\"t\"");
+                if (e.phase == 'C') std::fprintf(f, ",\"args\":{\"value\":%g}", e.value);
+                std::fprintf(f, "}");
+            }
+
+            size_t dropped = b->dropped.load(std::memory_order_relaxed);
+            if (dropped > 0) {
+                separator();
+                std::fprintf(f, "{\"name\":\"trace buffer full (%zu events dropped)\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+                             dropped, b->tid, n > 0 ? b->events[n - 1].ts / 1000.0 : 0.0);
+            }
+        }
+
+        std::fprintf(f, "\n]}\n");
+        std::fclose(f);
+        return true;
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+/*
+ * low-overhead trace recorder that writes Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * every thread records into its own fixed-size buffer without locking, with steady_clock timestamps
+ * relative to start(), so engine, job system and network threads all end up on one timeline.
+ * when tracing is off, a trace point costs one relaxed atomic load.
+ *
+ * event and thread names must outlive the trace (string literals are ideal): only the pointer is stored.
+ * define ENGINE_NO_TRACE to compile the TRACE_* macros out entirely.
+ */
+namespace Engine::Trace {
+
+    using Clock = std::chrono::steady_clock;
+
+    /*
+     * start recording, discarding anything recorded before. each thread keeps up to
+     * `eventsPerThread` events; later events on a full thread are dropped (and counted).
+     */
+    void start(size_t eventsPerThread = 1 << 16);
+
+    /*
+     * stop recording. the recorded events stay available to write().
+     */
+    void stop();
+
+    /*
+     * whether recording is on. read it through isEnabled().
+     */
+    extern std::atomic<bool> enabled;
+    inline bool isEnabled() {return enabled.load(std::memory_order_relaxed);}
+
+    /*
+     * write everything recorded since the last start() as Chrome trace JSON.
+     * best called after stop(); returns false if the file can't be opened.
+     */
+    bool write(const std::string& filename);
+
+    /*
+     * label the calling thread in the trace viewer.
+     */
+    void setThreadName(const char* name);
+
+    /*
+     * record a span that ran from `begin` to `end` on the calling thread.
+     */
+    void complete(const char* name, Clock::time_point begin, Clock::time_point end);
+
+    /*
+     * record a point in time on the calling thread.
+     */
+    void instant(const char* name);
+
+    /*
+     * record the value of a counter, drawn as a graph track.
+     */
+    void counter(const char* name, double value);
+
+    /*
+     * records the lifetime of its enclosing scope as a span.
+     */
+    class Scope {
+        public:
+            explicit Scope(const char* name) : name(isEnabled() ? name : nullptr) {
+                if (this->name) begin = Clock::now();
+            }
+            ~Scope() {
+                if (name) complete(name, begin, Clock::now());
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            const char* name;
+            Clock::time_point begin;
+    };
+
+    /*
+     * lock a mutex and record the time spent waiting for it, so contention shows up next to whoever holds it.
+     * use in place of std::lock_guard / std::unique_lock: auto lk = Trace::lock(mx, "wait mx");
+     */
+    template <typename Mutex>
+    std::unique_lock<Mutex> lock(Mutex& mutex, const char* name) {
+        if (!isEnabled()) return std::unique_lock<Mutex>(mutex);
+
+        Clock::time_point begin = Clock::now();
+        std::unique_lock<Mutex> lk(mutex);
+        complete(name, begin, Clock::now());
+        return lk;
+    }
+}
+
+#define ENGINE_TRACE_CONCAT_(a, b) a##b
+#define ENGINE_TRACE_CONCAT(a, b) ENGINE_TRACE_CONCAT_(a, b)
+
+#ifndef ENGINE_NO_TRACE
+    #define TRACE_SCOPE(name) ::Engine::Trace::Scope ENGINE_TRACE_CONCAT(traceScope_, __LINE__)(name)
+    #define TRACE_INSTANT(name) ::Engine::Trace::instant(name)
+    #define TRACE_COUNTER(name, value) ::Engine::Trace::counter(name, value)
+    #define TRACE_THREAD(name) ::Engine::Trace::setThreadName(name)
+#else
+    #define TRACE_SCOPE(name) ((void)0)
+    #define TRACE_INSTANT(name) ((void)0)
+    #define TRACE_COUNTER(name, value) ((void)0)
+    #define TRACE_THREAD(name) ((void)0)
+#endif
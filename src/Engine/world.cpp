@@ -0,0 +1,703 @@
+#include "world.h"
+#include "collision.h"
+#include "entity.h"
+#include "events.h"
+#include "physics.h"
+#include "JobSystem.hpp"
+#include "profiler.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Engine {
+
+    /*
+     * rows of kinematics per physics job. a multiple of the widest SIMD kernel.
+     */
+    static const size_t PHYSICS_CHUNK = 8192;
+
+    /*
+     * the defer() buffer of the parallel update chunk running on this thread, if any.
+     */
+    static thread_local std::vector<std::function<void()>>* tDeferred = nullptr;
+
+    /*
+     * where markDrawMoved lists rows from the parallel update chunk running on this thread, if any.
+     */
+    static thread_local std::vector<uint32_t>* tDrawMoved = nullptr;
+    static thread_local std::vector<uint32_t>* tCollideMoved = nullptr;
+
+    World::World(const std::string& name) : timeline(name), events(&timeline) {}
+
+    World::~World() {
+        flushDestroyed();
+        while (entities.size() > 0) {
+            Entity* e = entities.back();
+            delete e;
+        }
+    }
+
+    bool World::add(Entity* entity) {
+        if (entity->index != EntityHandle::INVALID) return false;
+
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = (uint32_t)slots.size();
+            slots.push_back({});
+        }
+
+        entity->index = (uint32_t)entities.size();
+        entity->handle = {slot, slots[slot].generation};
+        slots[slot].index = entity->index;
+        entities.push_back(entity);
+        kinematics.push();
+
+        // new rows start with physics on; move this one into the physics range.
+        swapRows(entity->index, (uint32_t)physicsCount);
+        physicsCount++;
+
+        entity->updateExtents();
+        setInPhase(entity, UPDATE, true);
+        setInPhase(entity, DRAW, entity->getTexture() != nullptr);
+        setInPhase(entity, COLLIDE, entity->hasCollisions());
+        return true;
+    }
+
+    bool World::remove(Entity* entity) {
+        uint32_t index = entity->index;
+        if (entity->world != this || index == EntityHandle::INVALID) return false;
+
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            setInPhase(entity, (Phase)phase, false);
+        }
+
+        // leave the physics range first so it stays contiguous, then swap the last row into the hole and pop.
+        setPhysics(entity, false);
+        swapRows(entity->index, (uint32_t)entities.size() - 1);
+        entities.pop_back();
+        kinematics.pop();
+
+        // bumping the generation invalidates every outstanding handle to this slot.
+        Slot& slot = slots[entity->handle.slot];
+        slot.index = EntityHandle::INVALID;
+        slot.generation++;
+        freeSlots.push_back(entity->handle.slot);
+
+        entity->index = EntityHandle::INVALID;
+        return true;
+    }
+
+    void World::swapRows(uint32_t a, uint32_t b) {
+        if (a == b) return;
+
+        std::swap(entities[a], entities[b]);
+        entities[a]->index = a;
+        entities[b]->index = b;
+        slots[entities[a]->handle.slot].index = a;
+        slots[entities[b]->handle.slot].index = b;
+        kinematics.swap(a, b);
+    }
+
+    void World::setPhysics(Entity* entity, bool on) {
+        if (entity->world != this || entity->index == EntityHandle::INVALID) return;
+        if (tDeferred) {
+            // moves rows other chunks may be using; wait for the merge.
+            tDeferred->push_back([this, h = entity->handle, on] {if (Entity* e = get(h)) setPhysics(e, on);});
+            return;
+        }
+        if (kinematics.has(entity->index, Kinematics::PHYSICS) == on) return;
+
+        kinematics.set(entity->index, Kinematics::PHYSICS, on);
+        // leaving the physics range means the indexes no longer refresh it every time; catch up once.
+        markMoved(entity->index);
+        if (on) {
+            swapRows(entity->index, (uint32_t)physicsCount);
+            physicsCount++;
+        } else {
+            physicsCount--;
+            swapRows(entity->index, (uint32_t)physicsCount);
+        }
+    }
+
+    void World::setInPhase(Entity* entity, Phase phase, bool in) {
+        if (entity->world != this || entity->index == EntityHandle::INVALID) return;
+        if (tDeferred) {
+            tDeferred->push_back([this, h = entity->handle, phase, in] {if (Entity* e = get(h)) setInPhase(e, phase, in);});
+            return;
+        }
+
+        PhaseList& list = phases[phase];
+        uint32_t& at = entity->phaseIndex[phase];
+        if (in == (at != EntityHandle::INVALID)) return;
+
+        if (in) {
+            at = (uint32_t)list.items.size();
+            list.items.push_back(entity);
+        } else {
+            list.items[at] = nullptr;
+            list.holes++;
+            at = EntityHandle::INVALID;
+        }
+
+        if (phase == DRAW) {
+            if (in) markDrawMoved(entity->index);
+            else {
+                drawIndex.remove(entity->handle.slot);
+                removeStatic(entity);
+            }
+        } else if (phase == COLLIDE) {
+            if (in) markMoved(entity->index);
+            else unindexCollider(entity->handle.slot);
+        }
+    }
+
+    void World::setStatic(Entity* entity, bool on) {
+        if (entity->world != this || entity->index == EntityHandle::INVALID) return;
+        if (tDeferred) {
+            tDeferred->push_back([this, h = entity->handle, on] {if (Entity* e = get(h)) setStatic(e, on);});
+            return;
+        }
+        if (entity->staticDraw == on) return;
+
+        entity->staticDraw = on;
+        // the next refresh files it under the other index.
+        if (on) drawIndex.remove(entity->handle.slot);
+        else removeStatic(entity);
+        markDrawMoved(entity->index);
+    }
+
+    void World::removeStatic(Entity* e) {
+        uint32_t slot = e->handle.slot;
+        if (!staticIndex.contains(slot)) return;
+        staticChanges.push_back(staticBoxes[slot]);
+        staticIndex.remove(slot);
+    }
+
+    void World::refreshStatic(Entity* e, size_t row, bool moved) {
+        Kinematics& k = kinematics;
+        SDL_FRect box{k.x[row], k.y[row], k.width[row], k.height[row]};
+        uint32_t slot = e->handle.slot;
+
+        if (staticIndex.contains(slot)) {
+            // physics rows come through every time; only a real change (or a flagged one) redraws.
+            const SDL_FRect& old = staticBoxes[slot];
+            if (!moved && old.x == box.x && old.y == box.y && old.w == box.w && old.h == box.h) return;
+            staticChanges.push_back(old);
+        }
+
+        if (slot >= staticBoxes.size()) staticBoxes.resize(slot + 1);
+        staticBoxes[slot] = box;
+        staticIndex.insert(slot, box);
+        staticChanges.push_back(box);
+    }
+
+    void World::markDrawMoved(size_t row) {
+        if (kinematics.has(row, Kinematics::DRAW_MOVED)) return;
+        kinematics.set(row, Kinematics::DRAW_MOVED, true);
+        uint32_t slot = entities[row]->handle.slot;
+        if (tDrawMoved) tDrawMoved->push_back(slot);
+        else drawMoved.push_back(slot);
+    }
+
+    void World::indexDrawable(size_t row) {
+        Kinematics& k = kinematics;
+        bool moved = k.has(row, Kinematics::DRAW_MOVED);
+        k.set(row, Kinematics::DRAW_MOVED, false);
+
+        Entity* e = entities[row];
+        if (e->phaseIndex[DRAW] == EntityHandle::INVALID) return;
+        if (e->staticDraw) {
+            refreshStatic(e, row, moved);
+            return;
+        }
+
+        float x0 = std::min(k.x[row], k.prevX[row]);
+        float y0 = std::min(k.y[row], k.prevY[row]);
+        float x1 = std::max(k.x[row], k.prevX[row]) + k.width[row];
+        float y1 = std::max(k.y[row], k.prevY[row]) + k.height[row];
+        drawIndex.insert(e->handle.slot, {x0, y0, x1 - x0, y1 - y0});
+    }
+
+    void World::refreshDrawIndex() {
+        // physics moves every row in its range, so those are all re-indexed; the rest only if listed.
+        for (size_t row = 0; row < physicsCount; row++) {
+            indexDrawable(row);
+        }
+        for (uint32_t slot : drawMoved) {
+            uint32_t row = slots[slot].index;
+            if (row == EntityHandle::INVALID || !kinematics.has(row, Kinematics::DRAW_MOVED)) continue;
+            indexDrawable(row);
+        }
+        drawMoved.clear();
+    }
+
+    void World::queryDrawable(const SDL_FRect& area, std::vector<Entity*>& out) {
+        refreshDrawIndex();
+
+        drawHits.clear();
+        drawIndex.query(area, drawHits);
+
+        size_t first = out.size();
+        for (uint32_t slot : drawHits) {
+            out.push_back(entities[slots[slot].index]);
+        }
+        std::sort(out.begin() + first, out.end(), [](Entity* a, Entity* b) {
+            return a->phaseIndex[DRAW] < b->phaseIndex[DRAW];
+        });
+    }
+
+    /*
+     * Collision::check counts boxes that only touch (and boxes with no size) as colliding, and the broadphases
+     * don't, so colliders are indexed and queried this much bigger on every side.
+     */
+    static const float COLLIDE_MARGIN = 0.5f;
+
+    static SDL_FRect grow(SDL_FRect box, float by) {
+        return {box.x - by, box.y - by, box.w + 2 * by, box.h + 2 * by};
+    }
+
+    void World::indexCollider(size_t row) {
+        Entity* e = entities[row];
+        if (e->phaseIndex[COLLIDE] == EntityHandle::INVALID) return;
+        const Kinematics& k = kinematics;
+        SDL_FRect box = grow({k.x[row], k.y[row], k.width[row], k.height[row]}, COLLIDE_MARGIN);
+        uint32_t slot = e->handle.slot;
+
+        switch (broadphase) {
+            case GRID: collideIndex.insert(slot, box); break;
+            case SWEEP_AND_PRUNE: collideSweep.insert(slot, box); break;
+            case AABB_TREE:
+                // physics rows, and anything that has moved since it was first indexed, go in the dynamic tree;
+                // the rest is level geometry.
+                if (row < physicsCount || collideDynamic.contains(slot) || collideStatic.contains(slot)) {
+                    if (collideStatic.contains(slot)) {
+                        collideStatic.remove(slot);
+                        staticTreeChanged = true;
+                    }
+                    collideDynamic.insert(slot, box);
+                } else {
+                    collideStatic.insert(slot, box);
+                    staticTreeChanged = true;
+                }
+                break;
+        }
+    }
+
+    void World::unindexCollider(uint32_t slot) {
+        switch (broadphase) {
+            case GRID: collideIndex.remove(slot); break;
+            case SWEEP_AND_PRUNE: collideSweep.remove(slot); break;
+            case AABB_TREE:
+                if (collideStatic.contains(slot)) {
+                    collideStatic.remove(slot);
+                    staticTreeChanged = true;
+                }
+                collideDynamic.remove(slot);
+                break;
+        }
+    }
+
+    void World::markCollideMoved(size_t row) {
+        if (kinematics.has(row, Kinematics::COLLIDE_MOVED)) return;
+        kinematics.set(row, Kinematics::COLLIDE_MOVED, true);
+        uint32_t slot = entities[row]->handle.slot;
+        if (tCollideMoved) tCollideMoved->push_back(slot);
+        else collideMoved.push_back(slot);
+    }
+
+    void World::refreshCollideIndex() {
+        Kinematics& k = kinematics;
+
+        // after a step the whole physics range has moved; otherwise only listed rows can have.
+        if (physicsMoved.exchange(false, std::memory_order_relaxed)) {
+            for (size_t row = 0; row < physicsCount; row++) {
+                k.set(row, Kinematics::COLLIDE_MOVED, false);
+                indexCollider(row);
+            }
+        }
+        for (uint32_t slot : collideMoved) {
+            uint32_t row = slots[slot].index;
+            if (row == EntityHandle::INVALID || !k.has(row, Kinematics::COLLIDE_MOVED)) continue;
+            k.set(row, Kinematics::COLLIDE_MOVED, false);
+            indexCollider(row);
+        }
+        collideMoved.clear();
+
+        // the static tree is only rebuilt, and its pairs only found, when something in it changed.
+        if (staticTreeChanged) {
+            staticTreeChanged = false;
+            collideStatic.rebuild();
+            staticPairs.clear();
+            collideStatic.pairs(staticPairs);
+        }
+    }
+
+    void World::queryCollidable(const SDL_FRect& area, std::vector<Entity*>& out) {
+        assert(!inParallelUpdate() && "collision queries aren't allowed in parallel updates; defer() them");
+        refreshCollideIndex();
+
+        collideHits.clear();
+        SDL_FRect box = grow(area, COLLIDE_MARGIN);
+        switch (broadphase) {
+            case GRID: collideIndex.query(box, collideHits); break;
+            case SWEEP_AND_PRUNE: collideSweep.query(box, collideHits); break;
+            case AABB_TREE:
+                collideStatic.query(box, collideHits);
+                collideDynamic.query(box, collideHits);
+                break;
+        }
+
+        size_t first = out.size();
+        for (uint32_t slot : collideHits) {
+            out.push_back(entities[slots[slot].index]);
+        }
+        std::sort(out.begin() + first, out.end(), [](Entity* a, Entity* b) {
+            return a->phaseIndex[COLLIDE] < b->phaseIndex[COLLIDE];
+        });
+    }
+
+    void World::queryCollidablePairs(std::vector<std::pair<Entity*, Entity*>>& out) {
+        assert(!inParallelUpdate() && "collision queries aren't allowed in parallel updates; defer() them");
+        refreshCollideIndex();
+
+        collidePairs.clear();
+        switch (broadphase) {
+            case GRID: collideIndex.pairs(collidePairs); break;
+            case SWEEP_AND_PRUNE: collideSweep.pairs(collidePairs); break;
+            case AABB_TREE:
+                collideDynamic.pairs(collidePairs);
+                collideDynamic.pairs(collideStatic, collidePairs);
+                collidePairs.insert(collidePairs.end(), staticPairs.begin(), staticPairs.end());
+                break;
+        }
+
+        size_t first = out.size();
+        for (const auto& [a, b] : collidePairs) {
+            Entity* ea = entities[slots[a].index];
+            Entity* eb = entities[slots[b].index];
+            if (ea->phaseIndex[COLLIDE] > eb->phaseIndex[COLLIDE]) std::swap(ea, eb);
+            out.emplace_back(ea, eb);
+        }
+        std::sort(out.begin() + first, out.end(), [](const std::pair<Entity*, Entity*>& a, const std::pair<Entity*, Entity*>& b) {
+            if (a.first->phaseIndex[COLLIDE] != b.first->phaseIndex[COLLIDE]) {
+                return a.first->phaseIndex[COLLIDE] < b.first->phaseIndex[COLLIDE];
+            }
+            return a.second->phaseIndex[COLLIDE] < b.second->phaseIndex[COLLIDE];
+        });
+    }
+
+    void World::reindexColliders() {
+        for (size_t row = 0; row < entities.size(); row++) {
+            markCollideMoved(row);
+        }
+    }
+
+    void World::setCollisionCellSize(float size) {
+        collideIndex.setCellSize(size);
+        if (broadphase == GRID) reindexColliders();
+    }
+
+    void World::setBroadphase(Broadphase b) {
+        if (b == broadphase) return;
+        broadphase = b;
+        // only the backend in use is kept up to date; start the new one from scratch.
+        collideIndex.clear();
+        collideSweep.clear();
+        collideStatic.clear();
+        collideDynamic.clear();
+        staticPairs.clear();
+        staticTreeChanged = false;
+        reindexColliders();
+    }
+
+    static bool handleLess(const EntityHandle& a, const EntityHandle& b) {
+        return a.slot != b.slot ? a.slot < b.slot : a.generation < b.generation;
+    }
+
+    static bool contactLess(const std::pair<EntityHandle, EntityHandle>& a, const std::pair<EntityHandle, EntityHandle>& b) {
+        if (a.first != b.first) return handleLess(a.first, b.first);
+        return handleLess(a.second, b.second);
+    }
+
+    void World::setContactEvents(bool on) {
+        contactEvents = on;
+        if (!on) contacts.clear();
+    }
+
+    bool World::inContact(Entity* a, Entity* b) const {
+        if (!a || !b || a->world != this || b->world != this) return false;
+        std::pair<EntityHandle, EntityHandle> key(a->getHandle(), b->getHandle());
+        if (handleLess(key.second, key.first)) std::swap(key.first, key.second);
+        return std::binary_search(contacts.begin(), contacts.end(), key, contactLess);
+    }
+
+    void World::updateContacts() {
+        if (!contactEvents) return;
+        Profiler::Scope timer(Profiler::CONTACTS);
+
+        contactChanges.clear();
+        contactPairs.clear();
+        Collision::pairs(*this, contactPairs);
+
+        nextContacts.clear();
+        for (const auto& [a, b] : contactPairs) {
+            EntityHandle ha = a->getHandle(), hb = b->getHandle();
+            if (handleLess(hb, ha)) std::swap(ha, hb);
+            nextContacts.emplace_back(ha, hb);
+        }
+        std::sort(nextContacts.begin(), nextContacts.end(), contactLess);
+
+        // both lists are sorted, so one merge finds what started and what ended. a reused slot has a new
+        // generation, so a pair with an entity deleted since the last frame never matches and just ends.
+        size_t i = 0, j = 0;
+        while (i < contacts.size() || j < nextContacts.size()) {
+            if (j == nextContacts.size() || (i < contacts.size() && contactLess(contacts[i], nextContacts[j]))) {
+                contactChanges.push_back({contacts[i++], false});
+            } else if (i == contacts.size() || contactLess(nextContacts[j], contacts[i])) {
+                contactChanges.push_back({nextContacts[j++], true});
+            } else {
+                i++;
+                j++;
+            }
+        }
+        contacts.swap(nextContacts);
+
+        // exits first, so a handler keeping count sees a pair end before the next one starts.
+        // handlers may destroy entities or turn contact events off, so resolve each handle as it's raised.
+        std::stable_partition(contactChanges.begin(), contactChanges.end(), [](const ContactChange& c) {return !c.enter;});
+        for (const ContactChange& change : contactChanges) {
+            Entity* a = get(change.pair.first);
+            Entity* b = get(change.pair.second);
+            if (!a && !b) continue;
+            events.raise(std::make_shared<CollisionEvent>(a, b, change.enter ? CollisionEvent::ENTER : CollisionEvent::EXIT));
+        }
+    }
+
+    void World::queryStatic(const SDL_FRect& area, std::vector<Entity*>& out) {
+        drawHits.clear();
+        staticIndex.query(area, drawHits);
+
+        size_t first = out.size();
+        for (uint32_t slot : drawHits) {
+            out.push_back(entities[slots[slot].index]);
+        }
+        std::sort(out.begin() + first, out.end(), [](Entity* a, Entity* b) {
+            return a->phaseIndex[DRAW] < b->phaseIndex[DRAW];
+        });
+    }
+
+    void World::takeStaticChanges(std::vector<SDL_FRect>& out) {
+        out.insert(out.end(), staticChanges.begin(), staticChanges.end());
+        staticChanges.clear();
+    }
+
+    void World::compact(Phase phase) {
+        PhaseList& list = phases[phase];
+        if (list.holes == 0 || list.iterating > 0) return;
+
+        size_t out = 0;
+        for (Entity* e : list.items) {
+            if (!e) continue;
+            e->phaseIndex[phase] = (uint32_t)out;
+            list.items[out++] = e;
+        }
+        list.items.resize(out);
+        list.holes = 0;
+    }
+
+    const std::vector<Entity*>& World::getPhase(Phase phase) {
+        compact(phase);
+        return phases[phase].items;
+    }
+
+    Entity* World::get(EntityHandle handle) const {
+        if (handle.slot >= slots.size()) return nullptr;
+        const Slot& slot = slots[handle.slot];
+        if (slot.generation != handle.generation || slot.index == EntityHandle::INVALID) return nullptr;
+        return entities[slot.index];
+    }
+
+    void World::destroy(Entity* entity) {
+        if (entity && entity->world == this) destroy(entity->getHandle());
+    }
+
+    void World::destroy(EntityHandle handle) {
+        if (tDeferred) {
+            tDeferred->push_back([this, handle] {destroy(handle);});
+            return;
+        }
+        if (isAlive(handle)) pendingDestroy.push_back(handle);
+    }
+
+    void World::defer(std::function<void()> fn) {
+        if (tDeferred) tDeferred->push_back(std::move(fn));
+        else fn();
+    }
+
+    bool World::inParallelUpdate() {return tDeferred != nullptr;}
+
+    void World::setJobSystem(JobSystem* jobs, size_t chunk) {
+        this->jobs = jobs;
+        updateChunk = std::max<size_t>(1, chunk);
+    }
+
+    void World::flushDestroyed() {
+        // deleting may queue more destroys (e.g. from a destructor), so drain by index.
+        for (size_t i = 0; i < pendingDestroy.size(); i++) {
+            delete get(pendingDestroy[i]);
+        }
+        pendingDestroy.clear();
+    }
+
+    void World::setFixedTimestep(float hz, int steps) {
+        fixedStep = hz > 0 ? 1.0f / hz : 0.0f;
+        maxSteps = std::max(1, steps);
+        accumulator = 0.0;
+        alpha = 1.0f;
+    }
+
+    void World::advance(float dt) {
+        if (fixedStep > 0) {
+            runFixedSteps(dt);
+        } else {
+            alpha = 1.0f;
+            simulate(dt);
+        }
+
+        updateContacts();
+        flushDestroyed();
+    }
+
+    void World::tick() {
+        timeline.tick();
+        advance(fixedStep > 0 ? timeline.getFrameTime() : timeline.getDelta());
+    }
+
+    void World::simulate(float dt) {
+        compact(UPDATE);
+        compact(PARALLEL_UPDATE);
+
+        {
+            Profiler::Scope timer(Profiler::PHYSICS);
+            integrate(dt);
+        }
+
+        Profiler::Scope timer(Profiler::UPDATE);
+        runParallelUpdates(dt);
+
+        // by index and skipping holes: update() may spawn entities or flip flags mid-iteration.
+
+        PhaseList& updates = phases[UPDATE];
+        updates.iterating++;
+        for (size_t i = 0; i < updates.items.size(); i++) {
+            if (Entity* e = updates.items[i])
+                e->update(dt);
+        }
+        updates.iterating--;
+    }
+
+    void World::integrate(float dt) {
+        size_t n = physicsCount;
+        if (!jobs || n <= PHYSICS_CHUNK) {
+            Physics::step(*this, dt);
+            return;
+        }
+
+        // rows are independent, so chunks can run in any order.
+        jobQueue.items.clear();
+        for (size_t begin = 0; begin < n; begin += PHYSICS_CHUNK) {
+            size_t end = std::min(n, begin + PHYSICS_CHUNK);
+            jobQueue.push([this, begin, end, dt] {Physics::step(*this, dt, begin, end);});
+        }
+        jobs->run(jobQueue);
+    }
+
+    /*
+     * update PARALLEL_UPDATE entities in fixed-size chunks, then replay each chunk's deferred calls in chunk order.
+     */
+    void World::runParallelUpdates(float dt) {
+        PhaseList& list = phases[PARALLEL_UPDATE];
+        size_t n = list.items.size();
+        if (n == 0) return;
+
+        size_t chunks = (n + updateChunk - 1) / updateChunk;
+        if (deferred.size() < chunks) deferred.resize(chunks);
+        if (chunkDrawMoved.size() < chunks) chunkDrawMoved.resize(chunks);
+        if (chunkCollideMoved.size() < chunks) chunkCollideMoved.resize(chunks);
+
+        list.iterating++;
+        jobQueue.items.clear();
+        for (size_t c = 0; c < chunks; c++) {
+            jobQueue.push([this, &list, c, n, dt] {
+                tDeferred = &deferred[c];
+                tDrawMoved = &chunkDrawMoved[c];
+                tCollideMoved = &chunkCollideMoved[c];
+                size_t end = std::min(n, (c + 1) * updateChunk);
+                for (size_t i = c * updateChunk; i < end; i++) {
+                    if (Entity* e = list.items[i])
+                        e->update(dt);
+                }
+                tDeferred = nullptr;
+                tDrawMoved = nullptr;
+                tCollideMoved = nullptr;
+            });
+        }
+
+        if (jobs) {
+            jobs->run(jobQueue);
+        } else {
+            for (size_t c = 0; c < chunks; c++) jobQueue[c]();
+        }
+        list.iterating--;
+
+        for (size_t c = 0; c < chunks; c++) {
+            drawMoved.insert(drawMoved.end(), chunkDrawMoved[c].begin(), chunkDrawMoved[c].end());
+            chunkDrawMoved[c].clear();
+            collideMoved.insert(collideMoved.end(), chunkCollideMoved[c].begin(), chunkCollideMoved[c].end());
+            chunkCollideMoved[c].clear();
+        }
+
+        // deferred calls may defer again or spawn entities; they run immediately now that tDeferred is clear.
+        for (size_t c = 0; c < chunks; c++) {
+            std::vector<std::function<void()>>& calls = deferred[c];
+            for (size_t i = 0; i < calls.size(); i++) calls[i]();
+            calls.clear();
+        }
+    }
+
+    /*
+     * run as many fixed steps as the accumulated frame time allows, then update the interpolation alpha.
+     */
+    void World::runFixedSteps(double frameTime) {
+        accumulator += frameTime;
+
+        int steps = 0;
+        while (accumulator >= fixedStep && steps < maxSteps) {
+            stepping = true;
+
+            std::copy(kinematics.x.begin(), kinematics.x.end(), kinematics.prevX.begin());
+            std::copy(kinematics.y.begin(), kinematics.y.end(), kinematics.prevY.begin());
+            simulate(fixedStep);
+            if (fixedUpdate) fixedUpdate(fixedStep);
+
+            stepping = false;
+            accumulator -= fixedStep;
+            steps++;
+        }
+
+        // too far behind to catch up; drop the backlog instead of spiralling.
+        if (accumulator >= fixedStep)
+            accumulator = std::fmod(accumulator, (double)fixedStep);
+
+        alpha = (float)(accumulator / fixedStep);
+    }
+
+    World& defaultWorld() {
+        // never destroyed: its entities can outlive the texture cache's statics, so Engine::quit() deletes them instead.
+        static World* world = new World("Timeline");
+        return *world;
+    }
+}
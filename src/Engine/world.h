@@ -0,0 +1,439 @@
+#pragma once
+#include "timeline.h"
+#include "event_manager.h"
+#include "kinematics.h"
+#include "Jobs.hpp"
+#include "aabb_tree.h"
+#include "spatial_hash.h"
+#include "sweep_prune.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class JobSystem;
+
+namespace Engine {
+    class Entity;
+
+    /*
+     * weak reference to an entity. stays safe to hold after the entity is destroyed:
+     * World::get() returns null once the slot has been reused or freed.
+     */
+    struct EntityHandle {
+        static constexpr uint32_t INVALID = UINT32_MAX;
+
+        uint32_t slot = INVALID;
+        uint32_t generation = 0;
+
+        bool isNull() const {return slot == INVALID;}
+        bool operator==(const EntityHandle& other) const {return slot == other.slot && generation == other.generation;}
+        bool operator!=(const EntityHandle& other) const {return !(*this == other);}
+    };
+
+    /*
+     * a self-contained simulation: its own entities, timeline, event manager, gravity and stepping state.
+     *
+     * worlds share nothing with each other, so a server can host several matches in one process
+     * and step each of them on its own thread. Engine::main() drives and draws defaultWorld().
+     */
+    class World {
+        public:
+            /*
+             * callback invoked once per fixed step, after physics and Entity::update.
+             */
+            using FixedUpdate = void (*)(float);
+
+            World(const std::string& name = "World");
+
+            /*
+             * deletes every entity still in the world.
+             */
+            ~World();
+
+            World(const World&) = delete;
+            World& operator=(const World&) = delete;
+
+            /*
+             * entities in this world. entities[i] owns row i of getKinematics().
+             * removal swaps the last entity into the freed spot, and enabling or disabling physics
+             * moves an entity across the physics boundary, so don't rely on the order.
+             */
+            std::vector<Entity*>& getEntities() {return entities;}
+
+            /*
+             * structure-of-arrays position/velocity/friction/extents data, one row per entity.
+             * rows [0, getPhysicsCount()) are exactly the entities with physics enabled.
+             */
+            Kinematics& getKinematics() {return kinematics;}
+            size_t getPhysicsCount() const {return physicsCount;}
+
+            /*
+             * enable or disable physics for an entity, moving its row in or out of the physics range.
+             * called by Entity::setPhysics; meant for internal use.
+             */
+            void setPhysics(Entity* entity, bool on);
+
+            /*
+             * the per-phase entity lists kept by the world, so each phase only visits the entities it needs:
+             *     UPDATE  - entities whose update() may do something (plain Entities drop out after their first update)
+             *     PARALLEL_UPDATE - like UPDATE, for entities that opted into Entity::setParallelUpdate
+             *     DRAW    - entities with a texture
+             *     COLLIDE - entities with collisions enabled
+             */
+            enum Phase {UPDATE = 0, PARALLEL_UPDATE, DRAW, COLLIDE, PHASE_COUNT};
+
+            /*
+             * get the entities in a phase, in the order they joined it.
+             * maintained incrementally by Entity::setCollisions and setTexture.
+             */
+            const std::vector<Entity*>& getPhase(Phase phase);
+
+            /*
+             * add/remove an entity to/from a phase list. called by the Entity setters; meant for internal use.
+             */
+            void setInPhase(Entity* entity, Phase phase, bool in);
+
+            /*
+             * append to `out` the DRAW phase entities whose box (between their previous and current position,
+             * so interpolated draws are covered) overlaps `area`, in DRAW phase order.
+             *
+             * backed by a spatial hash of drawable boxes that is brought up to date here: physics entities are
+             * re-indexed every call, other entities only when moved, resized or restyled through the Entity setters,
+             * which queue them on a list of changed rows, so entities that didn't change cost nothing.
+             * if you write positions straight into getKinematics(), call markMoved() on the row as well.
+             */
+            void queryDrawable(const SDL_FRect& area, std::vector<Entity*>& out);
+
+            /*
+             * the broadphase behind Collision::all and Collision::pairs: an index of COLLIDE phase bounding boxes,
+             * a uniform grid, sweep-and-prune along x or AABB trees (see setBroadphase). a point is a 0x0 area.
+             *
+             * queryCollidable appends the COLLIDE phase entities whose box overlaps or touches `area`, in COLLIDE phase
+             * order. queryCollidablePairs appends every pair of COLLIDE phase entities whose boxes overlap or touch,
+             * each once, as (earlier, later) in COLLIDE phase order.
+             *
+             * both are candidates: boxes are indexed with a small margin, so entities that come within a fraction
+             * of a pixel can be included too; Collision::check tells them apart. the index is brought up to date
+             * here, and only does any work if something moved since the last query: physics rows after a step,
+             * other rows when moved or resized through the Entity setters (or markMoved()).
+             * not thread-safe: refreshing and querying the index writes to it, so querying from a parallel entity
+             * update (or anything else it calls, like Collision::all) is an error, asserted in debug builds.
+             * defer() the query instead.
+             */
+            void queryCollidable(const SDL_FRect& area, std::vector<Entity*>& out);
+            void queryCollidablePairs(std::vector<std::pair<Entity*, Entity*>>& out);
+
+            /*
+             * cell size of the collision index, in pixels (default 128). a few times the size of a typical
+             * collider works best. re-indexes every collider on the next query.
+             */
+            void setCollisionCellSize(float size);
+            float getCollisionCellSize() const {return collideIndex.getCellSize();}
+
+            /*
+             * the collision index's backend. GRID (SpatialHash, the default) suits entities spread in both
+             * directions; SWEEP_AND_PRUNE (SweepAndPrune) suits wide, mostly horizontal levels, where entities
+             * are spread along x and move a little each frame. AABB_TREE (AABBTree) keeps queries O(log n) however
+             * unevenly sized or spread the colliders are: level geometry sits in a tree that is rebuilt (and its
+             * pairs found again) only when it changes, and physics entities, or anything that has moved since it
+             * was first indexed, in a dynamic tree with fattened boxes. switching re-indexes every collider on the
+             * next query.
+             */
+            enum Broadphase {
+                GRID,
+                SWEEP_AND_PRUNE,
+                AABB_TREE
+            };
+
+            void setBroadphase(Broadphase broadphase);
+            Broadphase getBroadphase() const {return broadphase;}
+
+            /*
+             * keep a cache of the pairs of COLLIDE phase entities that touch (as Collision::pairs sees them), and at the
+             * end of every advance() compare it with the pairs found then. each pair that started touching raises a
+             * CollisionEvent "collision_enter" through getEvents(), each one that stopped a "collision_exit", so
+             * handlers run once per change instead of checking every frame. a pair ends when either entity moves
+             * apart, loses its collisions or is deleted (that side of the exit is null). off by default.
+             *
+             * the check runs once per advance(), not per fixed step: a contact that starts and ends within one frame
+             * raises nothing.
+             */
+            void setContactEvents(bool on);
+            bool getContactEvents() const {return contactEvents;}
+
+            /*
+             * the pairs touching as of the last advance(), as handles, for asking what is still in contact.
+             * empty while contact events are off.
+             */
+            const std::vector<std::pair<EntityHandle, EntityHandle>>& getContacts() const {return contacts;}
+            bool inContact(Entity* a, Entity* b) const;
+
+            /*
+             * flag a row as moved or resized, for the draw and collision indexes. called by the Entity setters;
+             * needed when writing positions or extents straight into getKinematics(). safe from parallel updates.
+             */
+            void markMoved(size_t row) {
+                markDrawMoved(row);
+                markCollideMoved(row);
+            }
+
+            /*
+             * flag a row for the draw index only: its look changed (tint, layer, texture) but not its box.
+             * also safe from parallel updates.
+             */
+            void markDrawMoved(size_t row);
+
+            /*
+             * flag every physics row as moved. called by Physics::step; meant for internal use.
+             */
+            void markPhysicsMoved() {physicsMoved.store(true, std::memory_order_relaxed);}
+
+            /*
+             * static drawables (see Entity::setStatic) are kept out of queryDrawable and in an index of their own,
+             * for StaticLayerCache. both of these see the index as of the last queryDrawable, which is what
+             * brings it up to date, so call that first.
+             *
+             * queryStatic appends the static entities overlapping `area`, in DRAW phase order.
+             * takeStaticChanges appends every area whose static drawing has changed since the last call
+             * (the old and new box of each static entity that moved, resized, or changed texture, tint or layer,
+             * and the box of each one that was removed) and forgets them.
+             */
+            void queryStatic(const SDL_FRect& area, std::vector<Entity*>& out);
+            void takeStaticChanges(std::vector<SDL_FRect>& out);
+            size_t getStaticCount() const {return staticIndex.size();}
+
+            /*
+             * move an entity in or out of the static index. called by Entity::setStatic; meant for internal use.
+             */
+            void setStatic(Entity* entity, bool on);
+
+            /*
+             * the world's own clock, event manager and gravity (pixels/sec^2).
+             */
+            Timeline& getTimeline() {return timeline;}
+            EventManager& getEvents() {return events;}
+            float getGravity() const {return gravity;}
+            void setGravity(float g) {gravity = g;}
+
+            /*
+             * add/remove an entity in O(1). called automatically by the Entity constructor and destructor.
+             * add returns false if the entity is already in a world, remove if it isn't in this one.
+             *
+             * don't delete entities while the world is stepping (e.g. from Entity::update); use destroy() instead.
+             */
+            bool add(Entity* entity);
+            bool remove(Entity* entity);
+
+            /*
+             * resolve a handle. returns null if the entity has been destroyed.
+             */
+            Entity* get(EntityHandle handle) const;
+            bool isAlive(EntityHandle handle) const {return get(handle) != nullptr;}
+
+            /*
+             * queue an entity for deletion at the end of the current advance() (or the current frame in Engine::main()).
+             * safe to call at any time, including while the world is iterating; destroying twice is harmless.
+             */
+            void destroy(Entity* entity);
+            void destroy(EntityHandle handle);
+
+            /*
+             * delete every entity queued with destroy(). called automatically; only needed when driving the world by hand.
+             */
+            void flushDestroyed();
+
+            /*
+             * advance the world by dt seconds.
+             * in fixed-timestep mode dt is fed into the step accumulator, otherwise one step of dt is taken.
+             */
+            void advance(float dt);
+
+            /*
+             * tick the world's timeline and advance by the elapsed time.
+             * convenience for worlds that are stepped in real time outside of Engine::main().
+             */
+            void tick();
+
+            /*
+             * spread each step over a job system: physics runs on chunks of kinematics rows, and
+             * PARALLEL_UPDATE entities are updated `updateChunk` at a time. pass null to run single-threaded.
+             * the job system isn't owned by the world and may be shared by worlds stepped on the same thread.
+             *
+             * a step is
+             *     physics (chunked) -> parallel updates (chunked) -> deferred calls (in order) -> serial updates
+             * and chunk boundaries don't depend on the thread count, so the result is the same with or without workers
+             * as long as parallel updates keep to the rules in Entity::setParallelUpdate.
+             */
+            void setJobSystem(JobSystem* jobs, size_t updateChunk = 256);
+            JobSystem* getJobSystem() const {return jobs;}
+
+            /*
+             * run fn on the stepping thread once the parallel update phase is over.
+             * calls made from a parallel update are buffered per chunk and run in entity order, so anything
+             * touching shared state (spawning, events, other entities, phase changes) stays deterministic.
+             * outside a parallel update fn runs immediately.
+             */
+            void defer(std::function<void()> fn);
+
+            /*
+             * true on a thread while it runs a chunk of some world's parallel update phase.
+             */
+            static bool inParallelUpdate();
+
+            /*
+             * fixed-timestep configuration; see Engine::setFixedTimestep().
+             */
+            void setFixedTimestep(float hz, int maxSteps = 5);
+            float getFixedTimestep() const {return fixedStep;}
+            void setFixedUpdate(FixedUpdate update) {fixedUpdate = update;}
+
+            /*
+             * how far the world is between its previous and current fixed step, in [0, 1]. 1 outside fixed mode.
+             */
+            float getInterpolationAlpha() const {return alpha;}
+
+            /*
+             * true while the world is running a fixed simulation step.
+             */
+            bool inFixedStep() const {return stepping;}
+
+        private:
+            void simulate(float dt);
+            void integrate(float dt);
+            void runParallelUpdates(float dt);
+            void runFixedSteps(double frameTime);
+
+            /*
+             * maps handle slots to the entity's position in `entities`.
+             */
+            struct Slot {
+                uint32_t index = EntityHandle::INVALID;
+                uint32_t generation = 0;
+            };
+
+            /*
+             * a phase list. removal leaves a null hole (so it is safe mid-iteration and keeps the order),
+             * and holes are compacted away before the list is next iterated.
+             */
+            struct PhaseList {
+                std::vector<Entity*> items;
+                size_t holes = 0;
+                int iterating = 0;
+            };
+
+            void compact(Phase phase);
+
+            /*
+             * exchange two entities' places in `entities` and their kinematics rows.
+             */
+            void swapRows(uint32_t a, uint32_t b);
+
+            /*
+             * re-index the drawable entities that may have moved since the last queryDrawable.
+             */
+            void refreshDrawIndex();
+            void indexDrawable(size_t row);
+            void refreshStatic(Entity* e, size_t row, bool moved);
+            void removeStatic(Entity* e);
+
+            /*
+             * re-index the COLLIDE phase entities that may have moved since the last collision query.
+             */
+            void refreshCollideIndex();
+            void markCollideMoved(size_t row);
+            void indexCollider(size_t row);
+            void unindexCollider(uint32_t slot);
+            void reindexColliders();
+
+            /*
+             * find this frame's contacts and raise events for the pairs that changed since the last call.
+             */
+            void updateContacts();
+
+            std::vector<Entity*> entities;
+            Kinematics kinematics;
+            size_t physicsCount = 0;
+            PhaseList phases[PHASE_COUNT];
+            std::vector<Slot> slots;
+            std::vector<uint32_t> freeSlots;
+            std::vector<EntityHandle> pendingDestroy;
+
+            /*
+             * DRAW phase entities by handle slot, scratch space for queryDrawable, and the handle slots of rows
+             * flagged DRAW_MOVED since the last refresh (per chunk during the parallel update phase, merged after it).
+             * the flag doubles as "already listed"; slots whose row has lost it since are skipped.
+             */
+            SpatialHash drawIndex;
+            std::vector<uint32_t> drawHits;
+            std::vector<uint32_t> drawMoved;
+            std::vector<std::vector<uint32_t>> chunkDrawMoved;
+
+            /*
+             * static DRAW phase entities by handle slot, the box each was last indexed with, and the
+             * areas changed since the last takeStaticChanges.
+             */
+            SpatialHash staticIndex;
+            std::vector<SDL_FRect> staticBoxes;
+            std::vector<SDL_FRect> staticChanges;
+
+            /*
+             * COLLIDE phase entities by handle slot (in whichever backend is in use), scratch space for the
+             * collision queries, whether physics has moved its rows since the index was last refreshed, and the
+             * handle slots of rows flagged COLLIDE_MOVED since then (listed like drawMoved).
+             */
+            Broadphase broadphase = GRID;
+            SpatialHash collideIndex{128.0f};
+            SweepAndPrune collideSweep;
+            AABBTree collideStatic{0.0f};
+            AABBTree collideDynamic{4.0f};
+            std::vector<std::pair<uint32_t, uint32_t>> staticPairs;
+            bool staticTreeChanged = false;
+            std::vector<uint32_t> collideHits;
+            std::vector<std::pair<uint32_t, uint32_t>> collidePairs;
+            std::atomic<bool> physicsMoved{false};
+            std::vector<uint32_t> collideMoved;
+            std::vector<std::vector<uint32_t>> chunkCollideMoved;
+
+            /*
+             * a pair that started (enter) or stopped touching since the last updateContacts.
+             */
+            struct ContactChange {
+                std::pair<EntityHandle, EntityHandle> pair;
+                bool enter;
+            };
+
+            /*
+             * touching pairs as of the last updateContacts, sorted by handle, and scratch space for finding them.
+             */
+            bool contactEvents = false;
+            std::vector<std::pair<EntityHandle, EntityHandle>> contacts;
+            std::vector<std::pair<EntityHandle, EntityHandle>> nextContacts;
+            std::vector<std::pair<Entity*, Entity*>> contactPairs;
+            std::vector<ContactChange> contactChanges;
+
+            JobSystem* jobs = nullptr;
+            JobQueue jobQueue;
+            size_t updateChunk = 256;
+            std::vector<std::vector<std::function<void()>>> deferred;
+            Timeline timeline;
+            EventManager events;
+            float gravity = 2000;
+
+            FixedUpdate fixedUpdate = nullptr;
+            float fixedStep = 0.0f;
+            int maxSteps = 5;
+            double accumulator = 0.0;
+            float alpha = 1.0f;
+            bool stepping = false;
+    };
+
+    /*
+     * the world used by Engine::main(), Engine::getEntities()/Engine::getTimeline(), and every entity
+     * constructed without an explicit world.
+     * it is never destroyed; call Engine::quit() (Engine::main() does) to delete what's left in it.
+     */
+    World& defaultWorld();
+}
@@ -0,0 +1,146 @@
+// Builds an asset pack (see Engine/asset_pack.h) from PNG files, so the game can skip decoding them at startup.
+//
+//   AssetPacker OUTPUT INPUT... [--size PATH WxH]...
+//
+// Each INPUT is a .png file or a directory whose .png files are all packed. Images are stored under the path
+// they were given by (e.g. "media/hand.png", when run from the project root), which is the path the game loads
+// them by. --size also stores PATH pre-scaled to W x H; a side of 0 keeps the aspect ratio.
+
+#include "Engine/asset_pack.h"
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct ScaledSize {
+    std::string path;
+    int w, h;
+};
+
+struct PackConfig {
+    std::string output;
+    std::vector<std::string> inputs;
+    std::vector<ScaledSize> sizes;
+};
+
+static PackConfig gPack;
+
+static void usage(const char* exe) {
+    std::printf("Usage: %s OUTPUT INPUT... [--size PATH WxH]...\n", exe);
+    std::printf("  INPUT            a .png file, or a directory of them\n");
+    std::printf("  --size PATH WxH  also store PATH scaled to W x H (0 for one side keeps the aspect ratio)\n");
+}
+
+static bool parseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 2 < argc) {
+            ScaledSize size{argv[i + 1], 0, 0};
+            if (std::sscanf(argv[i + 2], "%dx%d", &size.w, &size.h) != 2 || size.w < 0 || size.h < 0 || size.w + size.h == 0) {
+                std::fprintf(stderr, "bad size '%s', expected WxH\n", argv[i + 2]);
+                return false;
+            }
+            gPack.sizes.push_back(size);
+            i += 2;
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            usage(argv[0]);
+            std::exit(0);
+        } else if (gPack.output.empty()) {
+            gPack.output = argv[i];
+        } else {
+            gPack.inputs.push_back(argv[i]);
+        }
+    }
+    return !gPack.output.empty() && !gPack.inputs.empty();
+}
+
+static bool isPNG(const std::filesystem::path& p) {
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) {return (char)std::tolower(c);});
+    return ext == ".png";
+}
+
+// Every .png named on the command line, with directories expanded, in a stable order.
+static std::vector<std::string> collectImages() {
+    std::vector<std::string> images;
+    for (const std::string& input : gPack.inputs) {
+        std::filesystem::path p(input);
+        if (std::filesystem::is_directory(p)) {
+            std::vector<std::string> found;
+            for (const auto& entry : std::filesystem::directory_iterator(p)) {
+                if (entry.is_regular_file() && isPNG(entry.path())) found.push_back(entry.path().generic_string());
+            }
+            std::sort(found.begin(), found.end());
+            images.insert(images.end(), found.begin(), found.end());
+        } else {
+            images.push_back(p.generic_string());
+        }
+    }
+    return images;
+}
+
+// Load an image as tightly-packed RGBA bytes.
+static SDL_Surface* loadRGBA(const std::string& path) {
+    SDL_Surface* loaded = IMG_Load(path.c_str());
+    if (!loaded) {
+        std::fprintf(stderr, "can't load %s: %s\n", path.c_str(), SDL_GetError());
+        return nullptr;
+    }
+    SDL_Surface* rgba = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(loaded);
+    if (!rgba) std::fprintf(stderr, "can't convert %s: %s\n", path.c_str(), SDL_GetError());
+    return rgba;
+}
+
+int main(int argc, char* argv[]) {
+    if (!parseArguments(argc, argv)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> images = collectImages();
+    for (const ScaledSize& size : gPack.sizes) {
+        if (std::find(images.begin(), images.end(), size.path) == images.end()) {
+            std::fprintf(stderr, "warning: --size %s doesn't name a packed image\n", size.path.c_str());
+        }
+    }
+
+    Engine::AssetPackWriter writer;
+    size_t bytes = 0;
+
+    for (const std::string& path : images) {
+        SDL_Surface* image = loadRGBA(path);
+        if (!image) return 1;
+        writer.add(path, image->w, image->h, image->pixels, image->pitch, true);
+        bytes += (size_t)image->w * image->h * 4;
+
+        for (const ScaledSize& size : gPack.sizes) {
+            if (size.path != path) continue;
+
+            int w = size.w, h = size.h;
+            if (w == 0) w = std::max(1, (int)(image->w * (float)h / image->h + 0.5f));
+            if (h == 0) h = std::max(1, (int)(image->h * (float)w / image->w + 0.5f));
+            if (w == image->w && h == image->h) continue;
+
+            SDL_Surface* scaled = SDL_ScaleSurface(image, w, h, SDL_SCALEMODE_LINEAR);
+            if (!scaled) {
+                std::fprintf(stderr, "can't scale %s to %dx%d: %s\n", path.c_str(), w, h, SDL_GetError());
+                SDL_DestroySurface(image);
+                return 1;
+            }
+            writer.add(path, w, h, scaled->pixels, scaled->pitch, false);
+            bytes += (size_t)w * h * 4;
+            SDL_DestroySurface(scaled);
+        }
+        SDL_DestroySurface(image);
+    }
+
+    if (!writer.write(gPack.output)) return 1;
+    std::printf("packed %zu images (%.1f MB of pixels) into %s\n", writer.getCount(), bytes / (1024.0 * 1024.0), gPack.output.c_str());
+    return 0;
+}
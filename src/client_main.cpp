@@ -17,6 +17,7 @@
 
 #include "Engine/engine.h"
 #include "Engine/collision.h"
+#include "Engine/events.h"
 #include "Engine/input.h"
 #include "Engine/scaling.h"
 #include "Engine/client.h"
@@ -30,7 +31,6 @@
 #include <SDL3/SDL.h>
 #include <zmq.h>
 #include <SDL3/SDL_scancode.h>
-#include <SDL3_image/SDL_image.h>
 #include <numeric>
 #include <cmath>
 
@@ -54,14 +54,23 @@ Engine::Entity* tombstone        = nullptr;
 Engine::Entity* main_platform    = nullptr;
 
 struct ControlState { bool move_left=false, move_right=false, activate_jump=false; };
+// what inputWorker wants the player to do: a horizontal speed, and a jump that stays queued until update() takes it.
+struct MoveIntent { float vx=0.0f; bool jump=false; };
+// guards current_controls, pending_intent and jump_engaged, which inputWorker shares with update().
+// the worker never touches the player itself: its entity lives in the world's arrays, which the main thread
+// can reallocate or reorder at any time, so update() applies the intent.
 static std::mutex control_mx;
 static ControlState current_controls;
+static MoveIntent pending_intent;
 static bool on_ground=false, jump_engaged=false;
 
 struct SurfaceAttachment { bool attached=false; Engine::Entity* surface=nullptr; float x_offset=0.0f; };
 static SurfaceAttachment player_attachment;
 static std::unordered_map<int, SurfaceAttachment> remote_attachments;
 
+// set by the contact handlers when the player runs into a hazard or the tombstone, handled in update().
+static bool hazard_contact=false, tombstone_contact=false;
+
 static float HAZARD_LEFT=0.f, HAZARD_RIGHT=0.f, HAZARD_LEVEL=0.f;
 static float hazard_velocity=60.f;
 static bool  hazard_direction_left=true;
@@ -70,10 +79,16 @@ static float V_MIN=0.f, V_MAX=0.f;
 static float vSpeed=140.f;
 static bool  vDown=true;
 
-static const float GHOST_SCALE = 0.28f;
+// set in CMakeLists.txt, which also builds the asset pack's ghost and hand sprites at this size.
+static const int GHOST_PX = GHOST_SPRITE_PX;
 static const float EDGE_PADDING = 40.0f;
 static const float PLATFORM_DEPTH = 80.0f;
 
+// draw layers, back to front. the platforms and tombstone stay on the default layer 0.
+static const int LAYER_REMOTES = 1;
+static const int LAYER_HAZARDS = 2;
+static const int LAYER_PLAYER  = 3;
+
 static Engine::Timeline gTimeline("GameTime");
 static bool paused=false, p_pressed=false, half_pressed=false, one_pressed=false, dbl_pressed=false;
 
@@ -117,8 +132,20 @@ struct PerfConfig {
     bool headless = true;
     bool perfMode = false;
     bool runExperiments = false;
+    float fixedHz = 0.0f;
+    Engine::Physics::Integrator integrator = Engine::Physics::AUTO;
+    Engine::World::Broadphase broadphase = Engine::World::GRID;
+    int workerThreads = 0;
+    bool profile = false;
+    std::string profileOut;
+    std::string traceOut;
+    bool pipeline = false;
+    std::string assetPack = "media/assets.pack";
+    bool internalResolution = false;
+    std::string overlayFont;
 };
 static PerfConfig gPerf;
+static Engine::Font gOverlayFont;
 
 struct NetworkConfig {
     bool useInputDelta = false;
@@ -175,6 +202,9 @@ struct DeathZone {
 };
 static std::vector<DeathZone> gDeathZones;
 
+// particle effects, see createEffects()
+static size_t gDeathFx = 0, gHazardFx = 0, gRespawnFx = 0;
+
 static constexpr bool kEnableScrolling = false;
 
 struct ScrollBoundary {
@@ -186,27 +216,11 @@ static bool gScrolling = false;
 static float gScrolledDistance = 0.0f;
 static float gScrollCooldown = 0.0f;
 
-// Load a texture from file with error handling
-static SDL_Texture* loadTexture(const char* path) {
-    SDL_Texture* tx = IMG_LoadTexture(Engine::renderer, path);
-    if (!tx) {
-        std::error_code ec; auto cwd = std::filesystem::current_path(ec).string();
-        LOGE("Failed to load %s (cwd=%s) : %s", path, cwd.c_str(), SDL_GetError());
-    }
-    return tx;
-}
-// Resize a texture to new dimensions using render target
-static SDL_Texture* resizeTexture(SDL_Texture* src, int w, int h) {
-    if (!src) return nullptr;
-    SDL_Texture* out = SDL_CreateTexture(Engine::renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
-    SDL_SetTextureBlendMode(out, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderTarget(Engine::renderer, out);
-    SDL_SetRenderDrawColor(Engine::renderer, 0,0,0,0);
-    SDL_RenderClear(Engine::renderer);
-    SDL_FRect dst{0,0,(float)w,(float)h};
-    SDL_RenderTexture(Engine::renderer, src, nullptr, &dst);
-    SDL_SetRenderTarget(Engine::renderer, nullptr);
-    return out;
+// Create an entity whose image loads in the background (drawn as a placeholder until then)
+static Engine::Entity* spriteEntity(const char* path, int w, int h, std::function<void(Engine::Entity*)> onReady = nullptr) {
+    Engine::Entity* e = new Engine::Entity((SDL_Texture*)nullptr);
+    e->setTextureAsync(path, w, h, std::move(onReady));
+    return e;
 }
 
 // Create JSON string for player data transmission
@@ -248,6 +262,43 @@ static void createDeathZones() {
     make(0, Engine::WINDOW_HEIGHT + 8, Engine::WINDOW_WIDTH, 1000);
 }
 
+// Emitters for falling out of the level, touching a hand and respawning
+static void createEffects() {
+    Engine::ParticleSystem& fx = Engine::getParticles();
+
+    Engine::ParticleEmitter death;
+    death.angle = -1.5708f;    // up, out of the bottom of the screen
+    death.spread = 1.4f;
+    death.speedMin = 250.0f; death.speedMax = 650.0f;
+    death.lifeMin = 0.6f; death.lifeMax = 1.1f;
+    death.gravity = 900.0f;
+    death.sizeStart = 10.0f; death.sizeEnd = 2.0f;
+    death.colorStart = {0.75f, 0.65f, 1.0f, 1.0f};
+    death.colorEnd = {0.3f, 0.2f, 0.5f, 0.0f};
+    gDeathFx = fx.addEmitter(death);
+
+    Engine::ParticleEmitter hazard;
+    hazard.speedMin = 150.0f; hazard.speedMax = 500.0f;
+    hazard.lifeMin = 0.3f; hazard.lifeMax = 0.7f;
+    hazard.gravity = 600.0f;
+    hazard.drag = 1.5f;
+    hazard.sizeStart = 7.0f; hazard.sizeEnd = 1.0f;
+    hazard.colorStart = {1.0f, 0.85f, 0.3f, 1.0f};
+    hazard.colorEnd = {0.9f, 0.1f, 0.1f, 0.0f};
+    hazard.blend = SDL_BLENDMODE_ADD;
+    gHazardFx = fx.addEmitter(hazard);
+
+    Engine::ParticleEmitter respawn;
+    respawn.speedMin = 140.0f; respawn.speedMax = 180.0f;
+    respawn.lifeMin = 0.4f; respawn.lifeMax = 0.6f;
+    respawn.drag = 3.0f;
+    respawn.sizeStart = 6.0f; respawn.sizeEnd = 0.0f;
+    respawn.colorStart = {0.8f, 1.0f, 1.0f, 1.0f};
+    respawn.colorEnd = {0.3f, 0.8f, 1.0f, 0.0f};
+    respawn.blend = SDL_BLENDMODE_ADD;
+    gRespawnFx = fx.addEmitter(respawn);
+}
+
 static void createScrollBoundary() {
     Engine::Obj::GameObject& obj = gRegistry.create();
     gTopBoundary = { SDL_FRect{0, 24, (float)Engine::WINDOW_WIDTH, 8}, obj.id() };
@@ -272,7 +323,11 @@ static void respawnAtCurrent() {
         player_character->setPos(spawn.x, spawn.y);
         player_character->setVelocity(0, 0);
         player_attachment = {true, main_platform, player_character->getPosX() - main_platform->getPosX()};
-        on_ground = true; jump_engaged = false;
+        on_ground = true;
+        { std::lock_guard<std::mutex> g(control_mx); jump_engaged = false; }
+
+        SDL_FRect pb = player_character->getBoundingBox();
+        Engine::getParticles().burst(gRespawnFx, pb.x + pb.w * 0.5f, pb.y + pb.h * 0.5f, 48);
     }
 
     gCurrentSpawn = (gCurrentSpawn + 1) % gSpawnPoints.size();
@@ -501,37 +556,35 @@ static void resetPlayerPosition() {
         player_character->setPos(cx - player_character->getWidth()/2,
                                  main_platform->getPosY() - player_character->getHeight());
         player_attachment = {true, main_platform, player_character->getPosX() - main_platform->getPosX()};
-        on_ground = true; jump_engaged=false;
+        on_ground = true;
+        { std::lock_guard<std::mutex> g(control_mx); jump_engaged = false; }
     }
 }
 static void initializeGameWorld() {
-    Engine::Scaling::setMode(Engine::Scaling::PROPORTIONAL_MAINTAIN_ASPECT_Y);
+    Engine::Scaling::setMode(gPerf.internalResolution ? Engine::Scaling::INTERNAL_RESOLUTION
+                                                      : Engine::Scaling::PROPORTIONAL_MAINTAIN_ASPECT_Y);
     Engine::Physics::setGravity(800.0f);
 
-    if (SDL_Texture* src = loadTexture("media/ghost_meh.png")) {
-        SDL_Texture* tx = resizeTexture(src, int(256*GHOST_SCALE), int(256*GHOST_SCALE));
-        SDL_DestroyTexture(src);
-        player_character = new Engine::Entity(tx);
-        player_character->setGravity(true);
-        player_character->setPhysics(true);
-        player_character->setFriction(20.0f, 0.0f);
-        player_character->setMaxSpeed(420.0f, 750.0f);
-    }
+    // sizes are given up front, so layout below doesn't have to wait for the images.
+    player_character = spriteEntity("media/ghost_meh.png", GHOST_PX, GHOST_PX);
+    player_character->setGravity(true);
+    player_character->setPhysics(true);
+    player_character->setFriction(20.0f, 0.0f);
+    player_character->setMaxSpeed(420.0f, 750.0f);
+    player_character->setLayer(LAYER_PLAYER);
 
-    if (SDL_Texture* src = loadTexture("media/hand.png")) {
-        SDL_Texture* tx = resizeTexture(src, int(256*GHOST_SCALE), int(256*GHOST_SCALE));
-        SDL_DestroyTexture(src);
-        hazard_object = new Engine::Entity(tx);
+    {
+        hazard_object = spriteEntity("media/hand.png", GHOST_PX, GHOST_PX);
         hazard_object->setGravity(false);
         hazard_object->setPhysics(false);
+        hazard_object->setLayer(LAYER_HAZARDS);
     }
 
-    if (SDL_Texture* src2 = loadTexture("media/hand.png")) {
-        SDL_Texture* tx2 = resizeTexture(src2, int(256*GHOST_SCALE), int(256*GHOST_SCALE));
-        SDL_DestroyTexture(src2);
-        hazard_object_v = new Engine::Entity(tx2);
+    {
+        hazard_object_v = spriteEntity("media/hand.png", GHOST_PX, GHOST_PX);
         hazard_object_v->setGravity(false);
         hazard_object_v->setPhysics(false);
+        hazard_object_v->setLayer(LAYER_HAZARDS);
 
         const float handW = hazard_object_v->getWidth();
         const float handH = hazard_object_v->getHeight();
@@ -548,30 +601,26 @@ static void initializeGameWorld() {
     float plat_w = (avail_w - 0.20f*Engine::WINDOW_WIDTH) / 2.0f;
     int   plat_h = (int)PLATFORM_DEPTH;
 
-    SDL_Texture* plat_src = loadTexture("media/platform_base.png");
-    SDL_Texture* plat_tx  = plat_src ? resizeTexture(plat_src, (int)plat_w, plat_h) : nullptr;
-    if (plat_src) SDL_DestroyTexture(plat_src);
-
-    floor_base = new Engine::Entity(plat_tx);  floor_base->setGravity(false);  floor_base->setPos(EDGE_PADDING, base_y);
-    side_platform = new Engine::Entity(plat_tx); side_platform->setGravity(false);
+    floor_base = spriteEntity("media/platform_base.png", (int)plat_w, plat_h);  floor_base->setGravity(false);  floor_base->setPos(EDGE_PADDING, base_y);
+    side_platform = spriteEntity("media/platform_base.png", (int)plat_w, plat_h); side_platform->setGravity(false);
     side_platform->setPos(Engine::WINDOW_WIDTH - EDGE_PADDING - plat_w, base_y);
 
-    SDL_Texture* top_tx = resizeTexture(plat_tx, int(plat_w*1.2f), plat_h);
-    if (top_tx) SDL_SetTextureColorMod(top_tx, 200, 150, 255);
-    main_platform = new Engine::Entity(top_tx);  main_platform->setGravity(false);
+    main_platform = spriteEntity("media/platform_base.png", int(plat_w*1.2f), plat_h);  main_platform->setGravity(false);
+    main_platform->setTint(200, 150, 255);
     main_platform->setPos(Engine::WINDOW_WIDTH*0.15f, Engine::WINDOW_HEIGHT * (2.0f/3.0f));
 
-    if (SDL_Texture* tomb_src = loadTexture("media/rip.png")) {
-        int tw=0, th=0; SDL_GetTextureSize(tomb_src, (float*)&tw, (float*)&th);
-        float desired_w = plat_w * 0.25f;
-        float s = (tw>0? desired_w/float(tw) : 1.0f);
-        SDL_Texture* tomb_tx = resizeTexture(tomb_src, int(tw*s), int(th*s));
-        SDL_DestroyTexture(tomb_src);
-        tombstone = new Engine::Entity(tomb_tx);
-        tombstone->setGravity(false);
-        tombstone->setPos(side_platform->getPosX() + side_platform->getWidth() - tombstone->getWidth() - 10,
-                          side_platform->getPosY() - tombstone->getHeight());
-    }
+    // the tombstone's height follows the image's aspect ratio, so it is placed once that is known.
+    auto placeTombstone = [](Engine::Entity* t) {
+        t->setPos(side_platform->getPosX() + side_platform->getWidth() - t->getWidth() - 10,
+                  side_platform->getPosY() - t->getHeight());
+    };
+    tombstone = spriteEntity("media/rip.png", int(plat_w * 0.25f), 0, placeTombstone);
+    tombstone->setGravity(false);
+    placeTombstone(tombstone);
+
+    // level geometry that only moves when the view scrolls is drawn from cached chunks. the main platform
+    // follows the server every frame, so it stays dynamic.
+    for (Engine::Entity* e : {floor_base, side_platform, tombstone}) e->setStatic(true);
 
     HAZARD_LEFT  = 10.0f;
     HAZARD_RIGHT = Engine::WINDOW_WIDTH - (hazard_object ? hazard_object->getWidth():64) - 10.0f;
@@ -579,8 +628,20 @@ static void initializeGameWorld() {
 
     if (hazard_object) hazard_object->setPos(HAZARD_RIGHT, HAZARD_LEVEL);
 
+    // hazards and the tombstone only matter when the player first touches them, so let the world say when.
+    Engine::World& world = Engine::defaultWorld();
+    world.setContactEvents(true);
+    world.getEvents().registerHandler("collision_enter", [](std::shared_ptr<Engine::Event> ev) {
+        auto contact = std::static_pointer_cast<Engine::CollisionEvent>(ev);
+        Engine::Entity* other = contact->other(player_character);
+        if (!other) return;
+        if (other == hazard_object || other == hazard_object_v) hazard_contact = true;
+        if (other == tombstone) tombstone_contact = true;
+    });
+
     createSpawnPoints();
     createDeathZones();
+    createEffects();
     if constexpr (kEnableScrolling) createScrollBoundary();
 
     resetPlayerPosition();
@@ -607,35 +668,51 @@ static void inputWorker() {
         int run = gSync.ticks - last; last = gSync.ticks; lk.unlock();
 
         for (int i=0;i<run;i++) {
-            ControlState s; { std::lock_guard<std::mutex> g(control_mx); s = current_controls; }
-
-            if (!paused) {
-                const float SPEED=250.f, JUMP=-600.f;
-                float vx = (s.move_left?-SPEED:0.f) + (s.move_right?SPEED:0.f);
-                player_character->setVelocityX(vx);
-                if (s.activate_jump && !jump_engaged) {
-                    player_character->setVelocityY(JUMP);
-                    player_attachment.attached=false; player_attachment.surface=nullptr;
-                }
-            } else {
-                player_character->setVelocityX(0);
-            }
+            std::lock_guard<std::mutex> g(control_mx);
+            const ControlState& s = current_controls;
+            const float SPEED=250.f;
+            pending_intent.vx = (s.move_left?-SPEED:0.f) + (s.move_right?SPEED:0.f);
+            if (s.activate_jump && !jump_engaged) pending_intent.jump = true;
             jump_engaged = s.activate_jump;
+        }
+    }
+}
 
-            if (gLocalObj != Engine::Obj::kInvalidId) {
-                if (auto* go = gRegistry.get(gLocalObj)) {
-                    if (auto* tr = go->get<Engine::Obj::Transform>()) {
-                        tr->x = player_character->getPosX();
-                        tr->y = player_character->getPosY();
-                    }
-                    if (auto* np = go->get<Engine::Obj::NetworkPlayer>()) {
-                        np->x  = player_character->getPosX();
-                        np->y  = player_character->getPosY();
-                        np->vx = player_character->getVelocityX();
-                        np->vy = player_character->getVelocityY();
-                    }
-                }
-            }
+// apply inputWorker's latest intent to the player. runs in update(), on the thread that steps the world.
+static void applyMoveIntent() {
+    MoveIntent intent;
+    {
+        std::lock_guard<std::mutex> g(control_mx);
+        intent = pending_intent;
+        pending_intent.jump = false;
+    }
+
+    if (paused) {
+        player_character->setVelocityX(0);
+        return;
+    }
+
+    const float JUMP=-600.f;
+    player_character->setVelocityX(intent.vx);
+    if (intent.jump) {
+        player_character->setVelocityY(JUMP);
+        player_attachment.attached=false; player_attachment.surface=nullptr;
+    }
+}
+
+// mirror the player into its networked game object.
+static void syncLocalObject() {
+    if (gLocalObj == Engine::Obj::kInvalidId) return;
+    if (auto* go = gRegistry.get(gLocalObj)) {
+        if (auto* tr = go->get<Engine::Obj::Transform>()) {
+            tr->x = player_character->getPosX();
+            tr->y = player_character->getPosY();
+        }
+        if (auto* np = go->get<Engine::Obj::NetworkPlayer>()) {
+            np->x  = player_character->getPosX();
+            np->y  = player_character->getPosY();
+            np->vx = player_character->getVelocityX();
+            np->vy = player_character->getVelocityY();
         }
     }
 }
@@ -669,37 +746,51 @@ static void handleSurfaceCollision(Engine::Entity* e, SurfaceAttachment& a,
     if (!a.attached) { a.surface=nullptr; a.x_offset=0.0f; }
 }
 
-static SDL_Texture* gRemoteAvatarTx = nullptr;
 // Main game update loop - handle input, physics, networking, and rendering
 static void update(float dt) {
     gTimeline.tick();
     gNowSeconds += dt;
 
+    // once the level's images are all in, the decoded originals every size was made from aren't needed.
+    static bool texturesTrimmed = false;
+    if (!texturesTrimmed && Engine::Textures::getPendingCount() == 0) {
+        Engine::Textures::trim();
+        texturesTrimmed = true;
+    }
+
     ControlState s;
     s.move_left  = Engine::Input::keyPressed("left");
     s.move_right = Engine::Input::keyPressed("right");
     s.activate_jump = Engine::Input::keyPressed("jump");
     { std::lock_guard<std::mutex> g(control_mx); current_controls = s; }
+    applyMoveIntent();
 
     std::vector<Engine::Entity*> surfaces = { floor_base, side_platform, main_platform };
     handleSurfaceCollision(player_character, player_attachment, surfaces);
     on_ground = player_attachment.attached;
 
-    if (tombstone && Engine::Collision::check(player_character, tombstone)) {
+    if (tombstone_contact) {
+        tombstone_contact = false;
         SDL_FRect pb = player_character->getBoundingBox(), tb=tombstone->getBoundingBox();
         player_character->setPosX(tb.x - pb.w - 2.0f);
         if (player_character->getVelocityX()>0) player_character->setVelocityX(0);
     }
 
     SDL_FRect pb = player_character->getBoundingBox();
-    if (isDead(pb) ||
-        (hazard_object && Engine::Collision::check(player_character, hazard_object)) ||
-        (hazard_object_v && Engine::Collision::check(player_character, hazard_object_v))) {
+    bool fell = isDead(pb);
+    bool hit = hazard_contact;
+    hazard_contact = false;
+    if (fell || hit) {
+        // falls end below the screen, so their burst comes up from its bottom edge.
+        float cx = pb.x + pb.w * 0.5f;
+        if (hit) Engine::getParticles().burst(gHazardFx, cx, pb.y + pb.h * 0.5f, 120);
+        else Engine::getParticles().burst(gDeathFx, cx, Engine::WINDOW_HEIGHT - 4.0f, 90);
         respawnAtCurrent();
     }
 
     if (pb.x < 0) player_character->setPosX(0);
     if (pb.x + pb.w > Engine::WINDOW_WIDTH) player_character->setPosX(Engine::WINDOW_WIDTH - pb.w);
+    syncLocalObject();
 
     static float sendAccum=0.f; sendAccum += (float)gTimeline.getDelta();
     const float target = 1.0f / gPublishHz;
@@ -787,14 +878,6 @@ static void update(float dt) {
     if (Engine::Input::keyPressed("speed_one"))  { if(!one_pressed)  gTimeline.setScale(1.0f); one_pressed=true; } else one_pressed=false;
     if (Engine::Input::keyPressed("speed_dbl"))  { if(!dbl_pressed)  gTimeline.setScale(2.0f); dbl_pressed=true; } else dbl_pressed=false;
 
-    if (!gRemoteAvatarTx) {
-        if (SDL_Texture* base = loadTexture("media/ghost_meh.png")) {
-            gRemoteAvatarTx = resizeTexture(base, int(256*GHOST_SCALE), int(256*GHOST_SCALE));
-            SDL_DestroyTexture(base);
-            SDL_SetTextureColorMod(gRemoteAvatarTx, 255, 120, 120);
-        }
-    }
-
     auto peers = network_client.p2pSnapshot();
 
     for (auto& [id, rp] : peers) {
@@ -803,9 +886,12 @@ static void update(float dt) {
 
         Engine::Entity*& e = gRemote[id];
         if (!e) {
-            e = new Engine::Entity(gRemoteAvatarTx);
+            // same image and size as the player, so this is a cache hit; remote avatars are told apart by their tint.
+            e = spriteEntity("media/ghost_meh.png", GHOST_PX, GHOST_PX);
+            e->setTint(255, 120, 120);
             e->setGravity(false);
             e->setPhysics(false);
+            e->setLayer(LAYER_REMOTES);
         }
 
         float cx = e->getPosX(), cy = e->getPosY();
@@ -847,21 +933,6 @@ static void update(float dt) {
         gPeerLastSeen.erase(id);
     }
 
-    if (!gPerf.perfMode) {
-        if (floor_base)    floor_base->draw();
-        if (side_platform) side_platform->draw();
-        if (main_platform) main_platform->draw();
-        if (tombstone)     tombstone->draw();
-        for (auto& kv : gRemote) {
-            if (kv.second && kv.second->getPosX() != -99999.0f) {
-                kv.second->draw();
-            }
-        }
-        if (hazard_object) hazard_object->draw();
-        if (hazard_object_v) hazard_object_v->draw();
-        if (player_character) player_character->draw();
-    }
-
     if (Engine::Input::keyPressed(SDL_SCANCODE_R)) resetPlayerPosition();
     if (Engine::Input::keyPressed(SDL_SCANCODE_ESCAPE)) Engine::stop();
 }
@@ -905,6 +976,13 @@ static void parseArguments(int argc, char* argv[]) {
             if (i + 1 < argc && argv[i+1][0] != '-') {
                 gPerf.csv = argv[++i];
             }
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            gPerf.profile = true;
+            if (i + 1 < argc && argv[i+1][0] != '-') {
+                gPerf.profileOut = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            gPerf.traceOut = argv[++i];
         } else if (strcmp(argv[i], "--strategy") == 0 && i + 1 < argc) {
             gPerf.strategy = argv[++i];
         } else if (strcmp(argv[i], "--publish") == 0 && i + 1 < argc) {
@@ -919,6 +997,22 @@ static void parseArguments(int argc, char* argv[]) {
             gPerf.headless = true;
         } else if (strcmp(argv[i], "--experiments") == 0) {
             gPerf.runExperiments = true;
+        } else if (strcmp(argv[i], "--fixed-hz") == 0 && i + 1 < argc) {
+            gPerf.fixedHz = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--integrator") == 0 && i + 1 < argc) {
+            gPerf.integrator = Engine::Physics::fromName(argv[++i]);
+        } else if (strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc) {
+            gPerf.broadphase = Engine::Collision::fromName(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            gPerf.workerThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            gPerf.pipeline = true;
+        } else if (strcmp(argv[i], "--internal-res") == 0) {
+            gPerf.internalResolution = true;
+        } else if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+            gPerf.assetPack = argv[++i];
+        } else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) {
+            gPerf.overlayFont = argv[++i];
         } else if (strcmp(argv[i], "--input-delta") == 0) {
             gNetConfig.useInputDelta = true;
         } else if (strcmp(argv[i], "--disconnect-handling") == 0) {
@@ -934,6 +1028,16 @@ static void parseArguments(int argc, char* argv[]) {
             LOGI("  --reps N          Number of repetitions");
             LOGI("  --headless        Run in headless mode");
             LOGI("  --experiments     Run performance experiments");
+            LOGI("  --fixed-hz HZ     Run physics at a fixed step rate (e.g. 120 to match the server)");
+            LOGI("  --integrator K    Physics kernel: auto, scalar, sse2 or avx2");
+            LOGI("  --broadphase K    Collision broadphase: grid, sweep (sweep-and-prune along x) or tree (AABB trees)");
+            LOGI("  --threads N       Step physics on N extra worker threads");
+            LOGI("  --profile [file]  Show the frame profiler overlay (and write it to a .csv or .json file on exit)");
+            LOGI("  --trace FILE      Record a Chrome trace of the engine and network threads, written on exit");
+            LOGI("  --pipeline        Simulate the next frame while the current one is presented");
+            LOGI("  --internal-res    Render at 1920x1080 and scale the whole frame to the window (letterboxed)");
+            LOGI("  --pack FILE       Load images from this asset pack (default media/assets.pack; 'none' to load the PNGs)");
+            LOGI("  --font FILE       TTF font for the profiler overlay (default: SDL's built-in 8x8 font)");
             LOGI("  --input-delta     Use input delta networking");
             LOGI("  --disconnect-handling Enable disconnect handling");
             LOGI("  --help, -h        Show this help");
@@ -943,8 +1047,16 @@ static void parseArguments(int argc, char* argv[]) {
 }
 
 // Launch the game client with initialization and main loop
+static void writeTrace() {
+    if (gPerf.traceOut.empty()) return;
+    Engine::Trace::stop();
+    if (Engine::Trace::write(gPerf.traceOut)) LOGI("Trace written to %s", gPerf.traceOut.c_str());
+    else LOGE("Could not write trace to %s", gPerf.traceOut.c_str());
+}
+
 static int LaunchClient(int argc, char* argv[]) {
     parseArguments(argc, argv);
+    if (!gPerf.traceOut.empty()) Engine::Trace::start();
 
     if (gPerf.perfMode && gPerf.headless) {
         SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
@@ -954,7 +1066,16 @@ static int LaunchClient(int argc, char* argv[]) {
         LOGE("Engine init failed: %s", SDL_GetError()); return 1;
     }
     mapInputs();
+    // built next to the executable by AssetPacker; without it every image is decoded from its PNG.
+    if (gPerf.assetPack != "none" && Engine::Textures::mountPack(gPerf.assetPack))
+        LOGI("Asset pack: %s", gPerf.assetPack.c_str());
     initializeGameWorld();
+    if (gPerf.fixedHz > 0) Engine::setFixedTimestep(gPerf.fixedHz);
+    LOGI("Physics integrator: %s", Engine::Physics::name(Engine::Physics::setIntegrator(gPerf.integrator)));
+    Engine::defaultWorld().setBroadphase(gPerf.broadphase);
+    LOGI("Collision broadphase: %s", Engine::Collision::name(gPerf.broadphase));
+    if (gPerf.workerThreads > 0) Engine::setWorkerThreads(gPerf.workerThreads);
+    Engine::setPipelinedRendering(gPerf.pipeline);
 
     std::string host = std::getenv("SERVER_HOST") ? std::getenv("SERVER_HOST") : "127.0.0.1";
     if (!network_client.start(host.c_str(), "Player"))
@@ -988,17 +1109,35 @@ static int LaunchClient(int argc, char* argv[]) {
         if (gTickThread.joinable()) gTickThread.join();
         if (gInputWorker.joinable()) gInputWorker.join();
         if (gWorldWorker.joinable()) gWorldWorker.join();
+        writeTrace();
+        Engine::quit();
         return rc;
     }
 
+    if (gPerf.profile) {
+        Engine::Profiler::setEnabled(true);
+        Engine::setOverlayRenderer(Engine::Profiler::drawOverlay);
+        if (!gPerf.overlayFont.empty() && gOverlayFont.open(gPerf.overlayFont, 13.0f))
+            Engine::Profiler::setOverlayFont(&gOverlayFont);
+    }
+
     int rc = Engine::main(update);
 
+    if (gPerf.profile && !gPerf.profileOut.empty()) {
+        std::string label = "client" + std::to_string(my_identifier);
+        bool json = gPerf.profileOut.size() > 5 && gPerf.profileOut.compare(gPerf.profileOut.size() - 5, 5, ".json") == 0;
+        if (!(json ? Engine::Profiler::writeJSON(gPerf.profileOut, label) : Engine::Profiler::writeCSV(gPerf.profileOut, label)))
+            LOGE("Could not write profile to %s", gPerf.profileOut.c_str());
+    }
+    gOverlayFont.close();
+
     network_client.shutdown();
     { std::lock_guard<std::mutex> lk(gSync.m); gSync.run.store(false); }
     gSync.cv.notify_all();
     if (gTickThread.joinable()) gTickThread.join();
     if (gInputWorker.joinable()) gInputWorker.join();
     if (gWorldWorker.joinable()) gWorldWorker.join();
+    writeTrace();
 
     return rc;
 }
@@ -0,0 +1,232 @@
+// Cost of finding every collision in a frame: the brute-force scan Collision::all() used to do against each
+// broadphase behind World's collision index (grid, sweep-and-prune and AABB trees), at 1k, 10k and 100k entities.
+//
+//   CollisionBenchmark [--frames N] [--csv file]
+//
+// Entities are 16x16 boxes scattered at the same density at every size, a quarter of them moving under
+// Physics::step, so each frame the index has to catch up with real movement. Two layouts: "square" spreads
+// them evenly in both directions, "strip" over a screen-high level that just gets wider, with the movers
+// mostly going along x like server_main's platforms. Per frame it measures:
+//   index  - bringing the index up to date after the step (paid once, by whichever query comes first)
+//   brute  - the old Collision::all(e) for every entity: a scan of the whole COLLIDE phase and a new vector each
+//   all    - Collision::all(e, buffer) for every entity, one reused buffer
+//   pairs  - Collision::pairs(), every overlapping pair at once
+//   point  - Collision::at() at every entity's center
+// Brute force is quadratic, so past BRUTE_SAMPLE entities it's timed on a sample and scaled up (marked *).
+// The broadphase's answers are checked against brute force on the entities it ran for.
+
+#include "Engine/engine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Engine;
+
+struct BenchConfig {
+    int frames = 10;
+    std::string csv;
+};
+
+static BenchConfig gBench;
+
+static const int BRUTE_SAMPLE = 1000;
+
+static void parseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            gBench.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            gBench.csv = argv[++i];
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::printf("Usage: %s [--frames N] [--csv file]\n", argv[0]);
+            std::exit(0);
+        }
+    }
+}
+
+// Scatter `count` boxes over an area sized so the density is the same at every count.
+static std::vector<Entity*> populate(World& world, int count, bool strip) {
+    const float SIZE = 16.0f;
+    const float SPACING = 48.0f;
+    float area = (float)count * SPACING * SPACING;
+    float height = strip ? (float)WINDOW_HEIGHT : std::sqrt(area);
+    float width = area / height;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> x(0.0f, width);
+    std::uniform_real_distribution<float> y(0.0f, height);
+    std::uniform_real_distribution<float> vel(-60.0f, 60.0f);
+
+    std::vector<Entity*> entities;
+    for (int i = 0; i < count; i++) {
+        Entity* e = new Entity(SIZE, SIZE, &world);
+        e->setPos(x(rng), y(rng));
+        e->setGravity(false);
+        e->setPhysics(i % 4 == 0);
+        if (strip) e->setVelocity(vel(rng) * 2.0f, vel(rng) * 0.1f);
+        else e->setVelocity(vel(rng), vel(rng));
+        entities.push_back(e);
+    }
+    return entities;
+}
+
+// What Collision::all() did before the broadphase.
+static std::vector<Entity*> bruteAll(World& world, Entity* e) {
+    std::vector<Entity*> out;
+    for (auto cmp : world.getPhase(World::COLLIDE)) {
+        if (!cmp || cmp == e) continue;
+        if (Collision::check(cmp, e)) out.push_back(cmp);
+    }
+    return out;
+}
+
+struct FrameTimes {
+    double index = 0, brute = 0, all = 0, pairs = 0, point = 0;
+    double pairCount = 0;
+    bool estimated = false;
+};
+
+static double msSince(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void writeCSV(const char* layout, World::Broadphase broadphase, int entities, const FrameTimes& t) {
+    if (gBench.csv.empty()) return;
+
+    FILE* f = std::fopen(gBench.csv.c_str(), std::filesystem::exists(gBench.csv) ? "a" : "w");
+    if (!f) return;
+
+    if (std::ftell(f) == 0) {
+        std::fprintf(f, "layout,broadphase,entities,frames,pairs,index_ms,brute_ms,brute_estimated,all_ms,pairs_ms,point_ms\n");
+    }
+
+    std::fprintf(f, "%s,%s,%d,%d,%.0f,%.3f,%.3f,%d,%.3f,%.3f,%.3f\n", layout, Collision::name(broadphase),
+                 entities, gBench.frames, t.pairCount,
+                 t.index, t.brute, t.estimated ? 1 : 0, t.all, t.pairs, t.point);
+    std::fclose(f);
+}
+
+// Step and query `count` entities for the configured number of frames. returns false if the broadphase disagreed.
+static bool run(int count, bool strip, World::Broadphase broadphase, FrameTimes& t) {
+    const float dt = 1.0f / 60.0f;
+
+    World world("CollisionBenchmark");
+    world.setBroadphase(broadphase);
+    std::vector<Entity*> entities = populate(world, count, strip);
+
+    size_t sample = std::min<size_t>(entities.size(), BRUTE_SAMPLE);
+    size_t stride = entities.size() / sample;
+    t.estimated = sample < entities.size();
+
+    std::vector<Entity*> buffer;
+    std::vector<std::pair<Entity*, Entity*>> pairs;
+    std::vector<Entity*> none;
+
+    // the first query builds the index from scratch; time the frames after that.
+    world.queryCollidable({-1e9f, -1e9f, 0, 0}, none);
+
+    for (int frame = 0; frame < gBench.frames; frame++) {
+        Physics::step(world, dt);
+
+        // an empty query brings the index up to date, so the timings below are just the queries.
+        auto phase = std::chrono::high_resolution_clock::now();
+        world.queryCollidable({-1e9f, -1e9f, 0, 0}, none);
+        t.index += msSince(phase);
+
+        std::vector<std::vector<Entity*>> expected(sample);
+        phase = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < sample; i++) {
+            expected[i] = bruteAll(world, entities[i * stride]);
+        }
+        t.brute += msSince(phase) * entities.size() / sample;
+
+        size_t hits = 0;
+        phase = std::chrono::high_resolution_clock::now();
+        for (Entity* e : entities) {
+            buffer.clear();
+            Collision::all(e, buffer);
+            hits += buffer.size();
+        }
+        t.all += msSince(phase);
+
+        pairs.clear();
+        phase = std::chrono::high_resolution_clock::now();
+        Collision::pairs(world, pairs);
+        t.pairs += msSince(phase);
+        t.pairCount += (double)pairs.size();
+
+        size_t inside = 0;
+        phase = std::chrono::high_resolution_clock::now();
+        for (Entity* e : entities) {
+            SDL_FRect box = e->getBoundingBox();
+            buffer.clear();
+            Collision::at(world, box.x + box.w * 0.5f, box.y + box.h * 0.5f, buffer);
+            inside += buffer.empty() ? 0 : 1;
+        }
+        t.point += msSince(phase);
+        if (inside != entities.size()) {
+            std::fprintf(stderr, "at() missed an entity's own center at %d entities\n", count);
+            return false;
+        }
+
+        // every pair is two hits, one from each side.
+        if (hits != pairs.size() * 2) {
+            std::fprintf(stderr, "all() found %zu hits but pairs() found %zu pairs at %d entities\n",
+                         hits, pairs.size(), count);
+            return false;
+        }
+        for (size_t i = 0; i < sample; i++) {
+            buffer.clear();
+            Collision::all(entities[i * stride], buffer);
+            if (buffer != expected[i]) {
+                std::fprintf(stderr, "%s and brute force disagree for entity %zu at %d entities\n",
+                             Collision::name(broadphase), i * stride, count);
+                return false;
+            }
+        }
+    }
+
+    t.index /= gBench.frames;
+    t.brute /= gBench.frames;
+    t.all /= gBench.frames;
+    t.pairs /= gBench.frames;
+    t.point /= gBench.frames;
+    t.pairCount /= gBench.frames;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    parseArguments(argc, argv);
+
+    const int sizes[] = {1000, 10000, 100000};
+
+    std::printf("%-7s %-6s %10s %8s %10s %12s %10s %10s %10s %10s %10s\n", "layout", "index",
+                "entities", "pairs", "index_ms", "brute_ms", "all_ms", "pairs_ms", "point_ms", "all_x", "pairs_x");
+
+    for (bool strip : {false, true}) {
+        const char* layout = strip ? "strip" : "square";
+        for (int count : sizes) {
+            for (World::Broadphase broadphase : {World::GRID, World::SWEEP_AND_PRUNE, World::AABB_TREE}) {
+                FrameTimes t;
+                if (!run(count, strip, broadphase, t)) return 1;
+
+                double indexed = std::max(t.index, 1e-6);
+                std::printf("%-7s %-6s %10d %8.0f %10.3f %11.3f%s %10.3f %10.3f %10.3f %10.1f %10.1f\n", layout,
+                            Collision::name(broadphase), count, t.pairCount, t.index, t.brute, t.estimated ? "*" : " ",
+                            t.all, t.pairs, t.point, t.brute / (indexed + t.all), t.brute / (indexed + t.pairs));
+                writeCSV(layout, broadphase, count, t);
+            }
+        }
+    }
+
+    std::printf("* brute force timed on %d entities and scaled up\n", BRUTE_SAMPLE);
+    return 0;
+}
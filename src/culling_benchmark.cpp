@@ -0,0 +1,200 @@
+// Cost of finding the entities to draw in a frame: a scan of the whole DRAW phase against World::queryDrawable's
+// spatial hash of drawable boxes, at 1k, 10k and 100k drawables.
+//
+//   CullingBenchmark [--frames N] [--csv file]
+//
+// Runs on SDL's offscreen video driver, so it needs no display. Entities are 16x16 sprites scattered at the
+// same density at every size, under a window-sized view that scrolls across them. An eighth of them are static
+// level geometry, a quarter move under physics (stepped at a fixed 60 Hz), and of the rest 1% are moved with
+// setPos and 1% re-tinted every frame, so the index has real changes to catch up with. Per frame it measures:
+//   refresh - bringing the index up to date (paid by the first queryDrawable of the frame)
+//   query   - queryDrawable over the view
+//   brute   - the old per-entity test: every DRAW phase entity's box against the view
+// The index's answers are checked against brute force every frame.
+
+#include "Engine/engine.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Engine;
+
+struct BenchConfig {
+    int frames = 60;
+    std::string csv;
+};
+
+static BenchConfig gBench;
+
+static void parseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            gBench.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            gBench.csv = argv[++i];
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::printf("Usage: %s [--frames N] [--csv file]\n", argv[0]);
+            std::exit(0);
+        }
+    }
+}
+
+struct FrameTimes {
+    double refresh = 0, query = 0, brute = 0;
+    double visible = 0;
+};
+
+static double msSince(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// What the draw loop did before the index: every non-static DRAW phase entity, in DRAW phase order, whose box
+// between its previous and current position overlaps the view (touching edges don't count, as in SpatialHash).
+static void bruteDrawable(World& world, const SDL_FRect& view, std::vector<Entity*>& out) {
+    for (Entity* e : world.getPhase(World::DRAW)) {
+        if (!e || e->isStatic()) continue;
+
+        SDL_FRect box = e->getBoundingBox();
+        Vec2 prev = e->getPrevPos();
+        float x0 = std::min(box.x, prev.x);
+        float y0 = std::min(box.y, prev.y);
+        float x1 = std::max(box.x, prev.x) + box.w;
+        float y1 = std::max(box.y, prev.y) + box.h;
+        SDL_FRect swept{x0, y0, x1 - x0, y1 - y0};
+        if (swept.x < view.x + view.w && view.x < swept.x + swept.w && swept.y < view.y + view.h && view.y < swept.y + swept.h)
+            out.push_back(e);
+    }
+}
+
+static void writeCSV(int entities, const FrameTimes& t) {
+    if (gBench.csv.empty()) return;
+
+    FILE* f = std::fopen(gBench.csv.c_str(), std::filesystem::exists(gBench.csv) ? "a" : "w");
+    if (!f) return;
+
+    if (std::ftell(f) == 0) {
+        std::fprintf(f, "entities,frames,visible,refresh_ms,query_ms,brute_ms\n");
+    }
+
+    std::fprintf(f, "%d,%d,%.0f,%.3f,%.3f,%.3f\n", entities, gBench.frames, t.visible, t.refresh, t.query, t.brute);
+    std::fclose(f);
+}
+
+// Step, change and cull `count` drawables for the configured number of frames. returns false if the index disagreed.
+static bool run(SDL_Texture* texture, int count, FrameTimes& t) {
+    const float dt = 1.0f / 60.0f;
+    const float SPACING = 48.0f;
+    float side = std::sqrt((float)count) * SPACING;
+
+    World world("CullingBenchmark");
+    world.setFixedTimestep(60.0f);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> pos(0.0f, side);
+    std::uniform_real_distribution<float> vel(-60.0f, 60.0f);
+
+    std::vector<Entity*> entities, still;
+    for (int i = 0; i < count; i++) {
+        Entity* e = new Entity(texture, &world);
+        e->setPos(pos(rng), pos(rng));
+        e->setGravity(false);
+        e->setPhysics(i % 4 == 0);
+        if (i % 4 == 0) e->setVelocity(vel(rng), vel(rng));
+        else if (i % 8 == 1) e->setStatic(true);
+        else still.push_back(e);
+        entities.push_back(e);
+    }
+
+    std::vector<Entity*> found, expected;
+    std::uniform_int_distribution<size_t> pick(0, still.size() - 1);
+    size_t changes = std::max<size_t>(1, still.size() / 100);
+
+    // the first query builds the index from scratch; time the frames after that.
+    world.queryDrawable({-1e9f, -1e9f, 0, 0}, found);
+
+    for (int frame = 0; frame < gBench.frames; frame++) {
+        world.advance(dt);
+        for (size_t i = 0; i < changes; i++) {
+            still[pick(rng)]->setPos(pos(rng), pos(rng));
+            still[pick(rng)]->setTint(255, (Uint8)(frame * 7), 255);
+        }
+
+        // the view sweeps diagonally across the level and wraps.
+        float travel = std::fmod(frame * 97.0f, std::max(1.0f, side - (float)WINDOW_WIDTH));
+        SDL_FRect view{travel, travel * 0.5f, (float)WINDOW_WIDTH, (float)WINDOW_HEIGHT};
+
+        // an empty query brings the index up to date, so the query timing below is just the lookup.
+        found.clear();
+        auto phase = std::chrono::high_resolution_clock::now();
+        world.queryDrawable({-1e9f, -1e9f, 0, 0}, found);
+        t.refresh += msSince(phase);
+
+        found.clear();
+        phase = std::chrono::high_resolution_clock::now();
+        world.queryDrawable(view, found);
+        t.query += msSince(phase);
+
+        expected.clear();
+        phase = std::chrono::high_resolution_clock::now();
+        bruteDrawable(world, view, expected);
+        t.brute += msSince(phase);
+
+        if (found != expected) {
+            std::fprintf(stderr, "queryDrawable found %zu entities but brute force found %zu at %d entities, frame %d\n",
+                         found.size(), expected.size(), count, frame);
+            return false;
+        }
+        t.visible += (double)found.size();
+    }
+
+    t.refresh /= gBench.frames;
+    t.query /= gBench.frames;
+    t.brute /= gBench.frames;
+    t.visible /= gBench.frames;
+
+    for (Entity* e : entities) delete e;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    parseArguments(argc, argv);
+
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    if (!Engine::init("CullingBenchmark")) return 1;
+
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, 16, 16);
+    if (!texture) {
+        std::fprintf(stderr, "Can't create a texture: %s\n", SDL_GetError());
+        Engine::quit();
+        return 1;
+    }
+
+    const int sizes[] = {1000, 10000, 100000};
+
+    std::printf("%10s %8s %12s %10s %10s %8s\n", "entities", "visible", "refresh_ms", "query_ms", "brute_ms", "brute_x");
+
+    int rc = 0;
+    for (int count : sizes) {
+        FrameTimes t;
+        if (!run(texture, count, t)) {
+            rc = 1;
+            break;
+        }
+
+        std::printf("%10d %8.0f %12.3f %10.3f %10.3f %8.1f\n", count, t.visible, t.refresh, t.query, t.brute,
+                    t.brute / std::max(t.refresh + t.query, 1e-6));
+        writeCSV(count, t);
+    }
+
+    SDL_DestroyTexture(texture);
+    Engine::quit();
+    return rc;
+}
@@ -0,0 +1,176 @@
+// Cost of a frame of particles (ParticleSystem update, record and draw) from 10k to 200k live particles.
+//
+//   ParticleBenchmark [--frames N] [--no-render] [--csv file]
+//
+// Runs on SDL's offscreen video driver, so it needs no display; set SDL_RENDER_DRIVER to pick the renderer.
+// Each kernel (scalar/SSE2/AVX2, see Physics::setIntegrator) simulates the same emitters at a fixed 60 Hz step:
+// particles are sprayed continuously at the rate that keeps the requested number alive, and timing starts once
+// the population has filled up. The frame column is update + record + draw and present; it has to stay under
+// 16.7 ms for the count to hold 60 Hz.
+
+#include "Engine/engine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace Engine;
+
+struct BenchConfig {
+    int frames = 300;
+    bool render = true;
+    std::string csv;
+};
+
+static BenchConfig gBench;
+
+static void parseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            gBench.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--no-render") == 0) {
+            gBench.render = false;
+        } else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            gBench.csv = argv[++i];
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::printf("Usage: %s [--frames N] [--no-render] [--csv file]\n", argv[0]);
+            std::exit(0);
+        }
+    }
+}
+
+struct FrameTimes {
+    double update = 0, record = 0, draw = 0;
+    double frameAvg = 0, frameP99 = 0;
+    double live = 0;
+};
+
+static double msSince(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void writeCSV(const char* kernel, int target, const FrameTimes& t) {
+    if (gBench.csv.empty()) return;
+
+    FILE* f = std::fopen(gBench.csv.c_str(), std::filesystem::exists(gBench.csv) ? "a" : "w");
+    if (!f) return;
+
+    if (std::ftell(f) == 0) {
+        std::fprintf(f, "kernel,target,live,frames,update_ms,record_ms,draw_ms,frame_avg_ms,frame_p99_ms\n");
+    }
+
+    std::fprintf(f, "%s,%d,%.0f,%d,%.3f,%.3f,%.3f,%.3f,%.3f\n", kernel, target, t.live, gBench.frames,
+                 t.update, t.record, t.draw, t.frameAvg, t.frameP99);
+    std::fclose(f);
+}
+
+// Simulate `target` live particles spread over the screen for the configured number of frames.
+static FrameTimes run(int target) {
+    const float dt = 1.0f / 60.0f;
+    const int EMITTERS = 8;
+    const float AVG_LIFE = 2.0f;
+
+    ParticleSystem particles((size_t)target * 2);
+    for (int i = 0; i < EMITTERS; i++) {
+        ParticleEmitter e;
+        e.lifeMin = AVG_LIFE * 0.5f;
+        e.lifeMax = AVG_LIFE * 1.5f;
+        e.speedMin = 20.0f;
+        e.speedMax = 400.0f;
+        e.jitter = 40.0f;
+        e.gravity = 200.0f;
+        e.drag = 0.5f;
+        e.sizeStart = 6.0f;
+        e.sizeEnd = 1.0f;
+        e.colorStart = {1.0f, 0.4f + 0.07f * i, 0.1f, 1.0f};
+        e.colorEnd = {0.3f, 0.1f, 0.1f, 0.0f};
+        e.rate = (float)target / (EMITTERS * AVG_LIFE);
+
+        size_t id = particles.addEmitter(e);
+        particles.setEmitterPosition(id, WINDOW_WIDTH * (i + 0.5f) / EMITTERS, WINDOW_HEIGHT * 0.4f);
+        particles.setEmitting(id, true);
+    }
+
+    // fill up: after the longest lifetime the population is steady.
+    int warmup = (int)(AVG_LIFE * 1.5f / dt) + 1;
+    for (int i = 0; i < warmup; i++) particles.update(dt);
+
+    ParticleBatch batch;
+    SDL_FRect view{0, 0, (float)WINDOW_WIDTH, (float)WINDOW_HEIGHT};
+    FrameTimes t;
+    std::vector<double> frames;
+
+    for (int i = 0; i < gBench.frames; i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        auto phase = std::chrono::high_resolution_clock::now();
+        particles.update(dt);
+        t.update += msSince(phase);
+
+        if (gBench.render) {
+            phase = std::chrono::high_resolution_clock::now();
+            particles.record(view, batch);
+            t.record += msSince(phase);
+
+            phase = std::chrono::high_resolution_clock::now();
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+            batch.flush(renderer, Scaling::Transform{});
+            SDL_RenderPresent(renderer);
+            t.draw += msSince(phase);
+        }
+
+        frames.push_back(msSince(start));
+        t.live += (double)particles.size();
+    }
+
+    t.update /= gBench.frames;
+    t.record /= gBench.frames;
+    t.draw /= gBench.frames;
+    t.live /= gBench.frames;
+    for (double f : frames) t.frameAvg += f;
+    t.frameAvg /= gBench.frames;
+    std::sort(frames.begin(), frames.end());
+    t.frameP99 = frames[(size_t)((frames.size() - 1) * 0.99)];
+    return t;
+}
+
+int main(int argc, char* argv[]) {
+    parseArguments(argc, argv);
+
+    if (gBench.render) {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        if (!Engine::init("ParticleBenchmark")) return 1;
+        // measure the work, not the display's refresh rate.
+        SDL_SetRenderVSync(renderer, 0);
+    }
+
+    const int sizes[] = {10000, 100000, 200000};
+
+    std::printf("%-8s %8s %8s %10s %10s %10s %10s %10s %6s\n",
+                "kernel", "target", "live", "update_ms", "record_ms", "draw_ms", "frame_ms", "p99_ms", "60Hz");
+
+    for (int target : sizes) {
+        for (Physics::Integrator kernel : {Physics::SCALAR, Physics::SSE2, Physics::AVX2}) {
+            if (!Physics::supports(kernel)) {
+                std::printf("%-8s %8d %8s\n", Physics::name(kernel), target, "unsupported");
+                continue;
+            }
+            Physics::setIntegrator(kernel);
+
+            FrameTimes t = run(target);
+            std::printf("%-8s %8d %8.0f %10.3f %10.3f %10.3f %10.3f %10.3f %6s\n",
+                        Physics::name(kernel), target, t.live, t.update, t.record, t.draw, t.frameAvg, t.frameP99,
+                        t.frameP99 < 1000.0 / 60.0 ? "yes" : "no");
+            writeCSV(Physics::name(kernel), target, t);
+        }
+    }
+
+    Physics::setIntegrator(Physics::AUTO);
+    if (gBench.render) Engine::quit();
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Throughput of the batch physics integrators (Physics::step) from 10k to 1M bodies.
+//
+//   PhysicsBenchmark [--steps N] [--reps N] [--csv file]
+//
+// Every supported integrator runs the same bodies from the same starting state, and the
+// results are checked against the scalar integrator bit for bit.
+
+#include "Engine/engine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Engine;
+
+struct BenchConfig {
+    int steps = 100;
+    int reps = 5;
+    std::string csv;
+};
+
+static BenchConfig gBench;
+
+static void parseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            gBench.steps = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            gBench.reps = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            gBench.csv = argv[++i];
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::printf("Usage: %s [--steps N] [--reps N] [--csv file]\n", argv[0]);
+            std::exit(0);
+        }
+    }
+}
+
+// Fill a world with bodies in a spread of states: some with gravity, friction or a speed cap, some without.
+static void populate(World& world, int count) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> pos(0.0f, 1920.0f);
+    std::uniform_real_distribution<float> vel(-600.0f, 600.0f);
+
+    for (int i = 0; i < count; i++) {
+        Entity* e = new Entity(16.0f, 16.0f, &world);
+        e->setPos(pos(rng), pos(rng));
+        e->setVelocity(vel(rng), vel(rng));
+        e->setGravity(i % 2 == 0);
+        if (i % 3 == 0) e->setFriction(200.0f, 50.0f);
+        if (i % 5 == 0) e->setMaxSpeed(400.0f, 400.0f);
+    }
+}
+
+static bool sameState(const Kinematics& a, const Kinematics& b) {
+    size_t bytes = a.size() * sizeof(float);
+    return std::memcmp(a.x.data(), b.x.data(), bytes) == 0 &&
+           std::memcmp(a.y.data(), b.y.data(), bytes) == 0 &&
+           std::memcmp(a.vx.data(), b.vx.data(), bytes) == 0 &&
+           std::memcmp(a.vy.data(), b.vy.data(), bytes) == 0;
+}
+
+static void writeCSV(const char* integrator, int bodies, double avg, double var) {
+    if (gBench.csv.empty()) return;
+
+    FILE* f = std::fopen(gBench.csv.c_str(), std::filesystem::exists(gBench.csv) ? "a" : "w");
+    if (!f) return;
+
+    if (std::ftell(f) == 0) {
+        std::fprintf(f, "integrator,bodies,steps,reps,avg_ms,var_ms,mbodies_per_s\n");
+    }
+
+    double rate = (double)bodies * gBench.steps / (avg * 1000.0);
+    std::fprintf(f, "%s,%d,%d,%d,%.3f,%.3f,%.1f\n", integrator, bodies, gBench.steps, gBench.reps, avg, var, rate);
+    std::fclose(f);
+}
+
+int main(int argc, char* argv[]) {
+    parseArguments(argc, argv);
+
+    const float dt = 1.0f / 120.0f;
+    const int sizes[] = {10000, 100000, 1000000};
+
+    std::printf("%-8s %10s %12s %12s %14s\n", "kernel", "bodies", "avg_ms", "ns/body", "Mbodies/s");
+
+    for (int bodies : sizes) {
+        World world("Benchmark");
+        populate(world, bodies);
+        const Kinematics initial = world.getKinematics();
+
+        Kinematics reference;
+        for (Physics::Integrator integrator : {Physics::SCALAR, Physics::SSE2, Physics::AVX2}) {
+            if (!Physics::supports(integrator)) {
+                std::printf("%-8s %10d %12s\n", Physics::name(integrator), bodies, "unsupported");
+                continue;
+            }
+            Physics::setIntegrator(integrator);
+
+            std::vector<double> results;
+            for (int rep = 0; rep < gBench.reps; rep++) {
+                world.getKinematics() = initial;
+
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int s = 0; s < gBench.steps; s++) {
+                    Physics::step(world, dt);
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                results.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+
+            if (integrator == Physics::SCALAR) {
+                reference = world.getKinematics();
+            } else if (!sameState(reference, world.getKinematics())) {
+                std::fprintf(stderr, "%s integrator diverged from scalar at %d bodies\n", Physics::name(integrator), bodies);
+                return 1;
+            }
+
+            double sum = 0, sum2 = 0;
+            for (double v : results) { sum += v; sum2 += v * v; }
+            double avg = sum / results.size();
+            double var = (sum2 / results.size()) - (avg * avg);
+            double perBody = avg * 1e6 / ((double)bodies * gBench.steps);
+
+            std::printf("%-8s %10d %12.3f %12.3f %14.1f\n", Physics::name(integrator), bodies, avg, perBody, 1000.0 / perBody);
+            writeCSV(Physics::name(integrator), bodies, avg, var);
+        }
+    }
+
+    Physics::setIntegrator(Physics::AUTO);
+    return 0;
+}
@@ -8,7 +8,10 @@
 #include <atomic>
 #include <csignal>
 #include <cstring>
+#include <mutex>
+#include <string>
 #include <zmq.h>
+#include "Engine/trace.h"
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #pragma comment(lib, "Ws2_32.lib")
@@ -47,6 +50,7 @@ static int gNumVertical = 1;
 static bool gEnablePerformanceTracking = false;
 static bool gEnableDisconnectHandling = true;
 static double gDisconnectTimeoutSeconds = 5.0;
+static std::string gTraceFile;
 
 static std::atomic<bool> running{true};
 static void on_sigint(int){ running.store(false); }
@@ -58,6 +62,7 @@ static void world_pub(void* ctx) {
     zmq_setsockopt(pub, ZMQ_CONFLATE, &one, sizeof(one));
     if (zmq_bind(pub, WORLD_ENDPOINT)!=0) { std::cerr << "[world] bind failed: " << zmq_strerror(zmq_errno()) << "\n"; zmq_close(pub); return; }
     std::cout << "[world] PUB @ 5556\n";
+    TRACE_THREAD("world");
 
     std::vector<DynPlatform> plats;
     float left=120.f, right=float(SCREEN_W-320);
@@ -91,6 +96,7 @@ static void world_pub(void* ctx) {
     while (running.load()) {
         auto now=clk::now();
         if (now>=nextSim) {
+            TRACE_SCOPE("world sim");
             double ds = dtSim.count();
             for (auto& p: plats) {
                 if (p.is_vertical) {
@@ -107,6 +113,7 @@ static void world_pub(void* ctx) {
             ++tick;
         }
         if (now>=nextPub) {
+            TRACE_SCOPE("world publish");
             WorldHdr hdr; hdr.tick=tick; hdr.plats=(uint32_t)plats.size();
             std::vector<uint8_t> buf(sizeof(hdr) + hdr.plats*sizeof(XY));
             std::memcpy(buf.data(), &hdr, sizeof(hdr));
@@ -119,6 +126,7 @@ static void world_pub(void* ctx) {
 
             nextPub += std::chrono::duration_cast<clk::duration>(dtPub);
         }
+        TRACE_SCOPE("world sleep");
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
     zmq_close(pub);
@@ -130,11 +138,13 @@ static void hello_rep(void* ctx) {
     int linger=0; zmq_setsockopt(rep, ZMQ_LINGER, &linger, sizeof(linger));
     if (zmq_bind(rep, CMD_ENDPOINT)!=0) { std::cerr << "[hello] bind failed\n"; zmq_close(rep); return; }
     std::cout << "[hello] REP @ 5555\n";
+    TRACE_THREAD("hello");
 
     int nextId=1;
     while (running.load()) {
         uint8_t buf[512]; int n = zmq_recv(rep, buf, sizeof(buf), ZMQ_DONTWAIT);
         if (n>0) {
+            TRACE_SCOPE("hello request");
             if (n >= (int)sizeof(Hello) && buf[0]==1) {
                 Welcome w; w.id = nextId++; zmq_send(rep, &w, sizeof(w), 0);
                 std::cout << "[hello] new id="<<w.id<<"\n";
@@ -153,19 +163,27 @@ static void directory_rep(void* ctx) {
     int linger=0; zmq_setsockopt(rep, ZMQ_LINGER, &linger, sizeof(linger));
     if (zmq_bind(rep, DIR_ENDPOINT)!=0) { std::cerr << "[dir] bind failed\n"; zmq_close(rep); return; }
     std::cout << "[dir] REP @ 5557\n";
+    TRACE_THREAD("dir");
 
+    // shared with the janitor thread.
     std::unordered_map<int32_t, ClientConn> peers;
+    std::mutex peersMx;
     int32_t nextId=1;
 
     std::thread janitor([&](){
+        TRACE_THREAD("dir janitor");
         while (running.load()) {
-            auto now=std::chrono::steady_clock::now();
-            const auto TO=std::chrono::seconds(static_cast<int>(gDisconnectTimeoutSeconds));
-            std::vector<int32_t> dead;
-            for (auto& [id,cc]:peers) if (now-cc.lastSeen>TO) dead.push_back(id);
-            for (auto id:dead) {
-                peers.erase(id);
-                std::cout << "[dir] pruned disconnected client " << id << "\n";
+            {
+                TRACE_SCOPE("prune peers");
+                auto lk = Engine::Trace::lock(peersMx, "wait peersMx");
+                auto now=std::chrono::steady_clock::now();
+                const auto TO=std::chrono::seconds(static_cast<int>(gDisconnectTimeoutSeconds));
+                std::vector<int32_t> dead;
+                for (auto& [id,cc]:peers) if (now-cc.lastSeen>TO) dead.push_back(id);
+                for (auto id:dead) {
+                    peers.erase(id);
+                    std::cout << "[dir] pruned disconnected client " << id << "\n";
+                }
             }
             std::this_thread::sleep_for(std::chrono::seconds(1));
         }
@@ -174,6 +192,8 @@ static void directory_rep(void* ctx) {
     while (running.load()) {
         uint8_t buf[1024]; int n=zmq_recv(rep, buf, sizeof(buf), ZMQ_DONTWAIT);
         if (n>0 && n>=(int)sizeof(PeerReg)) {
+            TRACE_SCOPE("dir request");
+            auto lk = Engine::Trace::lock(peersMx, "wait peersMx");
             auto* reg = reinterpret_cast<PeerReg*>(buf);
             int32_t id = reg->player_id; if (id<=0) id = nextId++;
             ClientConn cc; cc.port_be = htons(reg->pub_port); cc.lastSeen = std::chrono::steady_clock::now();
@@ -213,6 +233,8 @@ static void parseArguments(int argc, char* argv[]) {
             gEnableDisconnectHandling = true;
         } else if (strcmp(argv[i], "--disconnect-timeout") == 0 && i + 1 < argc) {
             gDisconnectTimeoutSeconds = std::max(1.0, std::min(60.0, atof(argv[++i])));
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            gTraceFile = argv[++i];
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             std::cout << "Usage: " << argv[0] << " [options]\n";
             std::cout << "Options:\n";
@@ -221,6 +243,7 @@ static void parseArguments(int argc, char* argv[]) {
             std::cout << "  --performance-tracking Enable performance tracking\n";
             std::cout << "  --disconnect-handling Enable disconnect handling\n";
             std::cout << "  --disconnect-timeout SEC Disconnect timeout in seconds (default: 5.0)\n";
+            std::cout << "  --trace FILE      Record a Chrome trace of the server threads, written on exit\n";
             std::cout << "  --help, -h        Show this help\n";
             exit(0);
         }
@@ -242,6 +265,8 @@ int main(int argc, char* argv[]) {
     void* ctx = zmq_ctx_new();
     if (!ctx) { std::cerr << "zmq_ctx_new failed\n"; return 1; }
 
+    if (!gTraceFile.empty()) Engine::Trace::start();
+
     std::thread t1([&]{ world_pub(ctx); });
     std::thread t2([&]{ hello_rep(ctx); });
     std::thread t3([&]{ directory_rep(ctx); });
@@ -252,6 +277,12 @@ int main(int argc, char* argv[]) {
     if (t2.joinable()) t2.join();
     if (t3.joinable()) t3.join();
 
+    if (!gTraceFile.empty()) {
+        Engine::Trace::stop();
+        if (Engine::Trace::write(gTraceFile)) std::cout << "Trace written to " << gTraceFile << "\n";
+        else std::cerr << "Could not write trace to " << gTraceFile << "\n";
+    }
+
     zmq_ctx_term(ctx);
     WSACleanup();
     std::cout << "Server stopped\n";